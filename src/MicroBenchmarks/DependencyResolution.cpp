@@ -0,0 +1,30 @@
+#include "benchmark/benchmark.h"
+//Provides a way to store end easily access client instances.
+#include "stormancer/IClientFactory.h"
+//Provides APIs related to authentication & user management.
+#include "Users/Users.hpp"
+//Provides APIs related to player parties.
+#include "Party/Party.hpp"
+
+//Resolves APIs from a client that is created but never connected: no network involved.
+static void ResolveFromClient(benchmark::State& state)
+{
+	Stormancer::IClientFactory::SetConfig(0, [](size_t) {
+		auto config = Stormancer::Configuration::create(std::string("http://localhost"), std::string("tests"), std::string("test"));
+		config->addPlugin(new Stormancer::Users::UsersPlugin());
+		config->addPlugin(new Stormancer::Party::PartyPlugin());
+		return config;
+	});
+	auto client = Stormancer::IClientFactory::GetClient(0);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(client->dependencyResolver().resolve<Stormancer::Users::UsersApi>());
+		benchmark::DoNotOptimize(client->dependencyResolver().resolve<Stormancer::Party::PartyApi>());
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+
+	client.reset();
+	Stormancer::IClientFactory::ReleaseClient(0);
+}
+BENCHMARK(ResolveFromClient);
@@ -0,0 +1,75 @@
+#include "benchmark/benchmark.h"
+#include "stormancer/Serializer.h"
+#include "../StressTool/TestDto.h"
+//Provides APIs related to player parties.
+#include "Party/Party.hpp"
+
+namespace
+{
+	Stormancer::Party::PartyRequestDto partyRequest()
+	{
+		Stormancer::Party::PartyRequestDto request;
+		request.GameFinderName = "matchmaking";
+		return request;
+	}
+
+	StressTool::TestDto testDto()
+	{
+		StressTool::TestDto dto;
+		dto.value = "42";
+		dto.boolean = true;
+		dto.number = 42;
+		return dto;
+	}
+
+	template<typename T>
+	void serialize(benchmark::State& state, const T& value)
+	{
+		Stormancer::Serializer serializer;
+		for (auto _ : state)
+		{
+			Stormancer::obytestream stream;
+			serializer.serialize(stream, value);
+			benchmark::DoNotOptimize(stream.bytes());
+		}
+	}
+
+	template<typename T>
+	void deserialize(benchmark::State& state, const T& value)
+	{
+		Stormancer::Serializer serializer;
+		Stormancer::obytestream output;
+		serializer.serialize(output, value);
+		auto bytes = output.bytes();
+		for (auto _ : state)
+		{
+			Stormancer::ibytestream stream(bytes.data(), bytes.size());
+			benchmark::DoNotOptimize(serializer.deserializeOne<T>(stream));
+		}
+		state.SetBytesProcessed(state.iterations() * bytes.size());
+	}
+}
+
+static void SerializePartyRequestDto(benchmark::State& state)
+{
+	serialize(state, partyRequest());
+}
+BENCHMARK(SerializePartyRequestDto);
+
+static void DeserializePartyRequestDto(benchmark::State& state)
+{
+	deserialize(state, partyRequest());
+}
+BENCHMARK(DeserializePartyRequestDto);
+
+static void SerializeTestDto(benchmark::State& state)
+{
+	serialize(state, testDto());
+}
+BENCHMARK(SerializeTestDto);
+
+static void DeserializeTestDto(benchmark::State& state)
+{
+	deserialize(state, testDto());
+}
+BENCHMARK(DeserializeTestDto);
@@ -0,0 +1,36 @@
+#include "benchmark/benchmark.h"
+#include "stormancer/Tasks.h"
+
+//Cost of a chain of continuations on a completed task, as built by the client for every request.
+static void TaskContinuationChain(benchmark::State& state)
+{
+	auto length = state.range(0);
+	for (auto _ : state)
+	{
+		auto task = pplx::task_from_result(0);
+		for (int64_t i = 0; i < length; i++)
+		{
+			task = task.then([](int v) { return v + 1; });
+		}
+		benchmark::DoNotOptimize(task.get());
+	}
+	state.SetItemsProcessed(state.iterations() * length);
+}
+BENCHMARK(TaskContinuationChain)->Arg(1)->Arg(4)->Arg(16);
+
+//Same chain, using task based continuations that observe errors, as most of the tests do.
+static void TaskBasedContinuationChain(benchmark::State& state)
+{
+	auto length = state.range(0);
+	for (auto _ : state)
+	{
+		auto task = pplx::task_from_result(0);
+		for (int64_t i = 0; i < length; i++)
+		{
+			task = task.then([](pplx::task<int> t) { return t.get() + 1; });
+		}
+		benchmark::DoNotOptimize(task.get());
+	}
+	state.SetItemsProcessed(state.iterations() * length);
+}
+BENCHMARK(TaskBasedContinuationChain)->Arg(1)->Arg(4)->Arg(16);
@@ -0,0 +1,25 @@
+#include "benchmark/benchmark.h"
+#include "../StressTool/Timer.h"
+
+//The stress tool measures every operation with a Timer.
+static void TimerStartElapsed(benchmark::State& state)
+{
+	Timer timer;
+	for (auto _ : state)
+	{
+		timer.start();
+		benchmark::DoNotOptimize(timer.getElapsedTimeInMilliSec());
+	}
+}
+BENCHMARK(TimerStartElapsed);
+
+static void TimerElapsed(benchmark::State& state)
+{
+	Timer timer;
+	timer.start();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(timer.getElapsedTimeInMilliSec());
+	}
+}
+BENCHMARK(TimerElapsed);
@@ -0,0 +1,4 @@
+#include "benchmark/benchmark.h"
+
+//Run with --benchmark_format=json --benchmark_out=results.json to track results over time.
+BENCHMARK_MAIN();
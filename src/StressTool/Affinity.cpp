@@ -0,0 +1,185 @@
+#include "Affinity.h"
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	std::mutex measuringMutex;
+	std::vector<int> measuringCpus;
+}
+
+bool StressTool::Affinity::parse(const std::string& list, std::vector<int>& cpus)
+{
+	cpus.clear();
+	std::stringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		try
+		{
+			auto dash = range.find('-');
+			auto first = std::stoi(range.substr(0, dash));
+			auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+			if (first < 0 || last < first)
+			{
+				return false;
+			}
+			for (auto cpu = first; cpu <= last; cpu++)
+			{
+				cpus.push_back(cpu);
+			}
+		}
+		catch (std::exception&)
+		{
+			return false;
+		}
+	}
+	return !cpus.empty();
+}
+
+bool StressTool::Affinity::numaNodeCpus(int node, std::vector<int>& cpus)
+{
+#if defined(WIN32) || defined(_WIN32)
+	GROUP_AFFINITY affinity;
+	if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) || affinity.Group != 0)
+	{
+		return false;
+	}
+	cpus.clear();
+	for (int cpu = 0; cpu < 64; cpu++)
+	{
+		if (affinity.Mask & (static_cast<KAFFINITY>(1) << cpu))
+		{
+			cpus.push_back(cpu);
+		}
+	}
+	return !cpus.empty();
+#elif defined(__linux__)
+	std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string list;
+	return std::getline(file, list) && parse(list, cpus);
+#else
+	return false;
+#endif
+}
+
+bool StressTool::Affinity::pinCurrentThread(const std::vector<int>& cpus)
+{
+#if defined(WIN32) || defined(_WIN32)
+	//Only the first processor group (64 CPUs) is supported.
+	DWORD_PTR mask = 0;
+	for (auto cpu : cpus)
+	{
+		if (cpu >= 64)
+		{
+			return false;
+		}
+		mask |= static_cast<DWORD_PTR>(1) << cpu;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : cpus)
+	{
+		if (cpu >= CPU_SETSIZE)
+		{
+			return false;
+		}
+		CPU_SET(cpu, &set);
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+void StressTool::Affinity::setMeasuringCpus(const std::vector<int>& cpus)
+{
+	std::lock_guard<std::mutex> lg(measuringMutex);
+	measuringCpus = cpus;
+}
+
+void StressTool::Affinity::pinMeasuringThread()
+{
+	std::vector<int> cpus;
+	{
+		std::lock_guard<std::mutex> lg(measuringMutex);
+		cpus = measuringCpus;
+	}
+	if (!cpus.empty())
+	{
+		pinCurrentThread(cpus);
+	}
+}
+
+std::string StressTool::Affinity::format(const std::vector<int>& cpus)
+{
+	std::string result;
+	for (std::size_t i = 0; i < cpus.size();)
+	{
+		auto j = i;
+		while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+		{
+			j++;
+		}
+		result += (result.empty() ? "" : ",") + std::to_string(cpus[i]) + (j > i ? "-" + std::to_string(cpus[j]) : "");
+		i = j + 1;
+	}
+	return result;
+}
+
+std::vector<StressTool::Affinity::CoreTimes> StressTool::Affinity::coreTimes()
+{
+	std::vector<CoreTimes> result;
+#ifdef __linux__
+	//Lines "cpuN user nice system idle iowait irq softirq steal ..." follow the "cpu" total line.
+	std::ifstream stat("/proc/stat");
+	std::string line;
+	while (std::getline(stat, line))
+	{
+		if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 || line[3] == ' ')
+		{
+			continue;
+		}
+		std::istringstream fields(line);
+		std::string name;
+		std::uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+		fields >> name >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+		auto index = std::stoul(name.substr(3));
+		if (index >= result.size())
+		{
+			result.resize(index + 1, CoreTimes{ 0, 0 });
+		}
+		result[index].busy = user + nice + system + irq + softirq + steal;
+		result[index].total = result[index].busy + idle + iowait;
+	}
+#endif
+	return result;
+}
+
+void StressTool::Affinity::printCoreUsage(std::ostream& out, const std::vector<CoreTimes>& before, const std::vector<CoreTimes>& after)
+{
+	if (before.empty() || before.size() != after.size())
+	{
+		out << "per core utilization : n/a\n";
+		return;
+	}
+	out << "per core utilization (%) :\n";
+	for (std::size_t i = 0; i < after.size(); i++)
+	{
+		auto total = after[i].total - before[i].total;
+		auto usage = total > 0 ? 100.0 * (after[i].busy - before[i].busy) / total : 0;
+		out << "  cpu" << std::setw(3) << std::left << i << std::right << std::setw(6) << std::fixed << std::setprecision(1) << usage << (i % 8 == 7 ? "\n" : "");
+	}
+	out << std::defaultfloat << (after.size() % 8 ? "\n" : "");
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Pins threads of the tool to CPU sets, to separate the threads generating load from the threads measuring it.
+	/// </summary>
+	/// <remarks>
+	/// Threads inherit the affinity of the thread creating them: pinning the main thread before creating clients pins the library and pplx threads too.
+	/// </remarks>
+	namespace Affinity
+	{
+		/// <summary>
+		/// Parses a CPU list such as "0-3,8,10-11".
+		/// </summary>
+		bool parse(const std::string& list, std::vector<int>& cpus);
+
+		/// <summary>
+		/// Gets the CPUs of a NUMA node.
+		/// </summary>
+		bool numaNodeCpus(int node, std::vector<int>& cpus);
+
+		/// <summary>
+		/// Restricts the calling thread, and the threads it creates afterwards, to cpus.
+		/// </summary>
+		bool pinCurrentThread(const std::vector<int>& cpus);
+
+		/// <summary>
+		/// Sets the CPUs of the threads measuring the run, such as the perf counters scanner.
+		/// </summary>
+		void setMeasuringCpus(const std::vector<int>& cpus);
+
+		/// <summary>
+		/// Pins the calling thread to the measuring CPUs, if they were set.
+		/// </summary>
+		void pinMeasuringThread();
+
+		std::string format(const std::vector<int>& cpus);
+
+		/// <summary>
+		/// Busy and total time of each core, in clock ticks since boot. Empty if not available on this platform.
+		/// </summary>
+		struct CoreTimes
+		{
+			std::uint64_t busy;
+			std::uint64_t total;
+		};
+
+		std::vector<CoreTimes> coreTimes();
+
+		/// <summary>
+		/// Prints the utilization of each core between two coreTimes() calls.
+		/// </summary>
+		void printCoreUsage(std::ostream& out, const std::vector<CoreTimes>& before, const std::vector<CoreTimes>& after);
+	}
+}
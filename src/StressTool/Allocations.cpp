@@ -0,0 +1,215 @@
+#include "Allocations.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	constexpr int MaxSteps = 64;
+	constexpr int MaxThreads = 1024;
+
+	struct Counter
+	{
+		std::atomic<std::uint64_t> count;
+		std::atomic<std::uint64_t> bytes;
+	};
+
+	//Counters are written by a single thread, except the last slot shared by threads beyond MaxThreads.
+	struct ThreadSlot
+	{
+		Counter total;
+		Counter steps[MaxSteps];
+	};
+
+	ThreadSlot slots[MaxThreads];
+	std::atomic<int> nextSlot{ 0 };
+
+	//Step 0 collects allocations made outside of any step.
+	const char* stepNames[MaxSteps] = { "(outside steps)" };
+	std::atomic<int> stepCount{ 1 };
+	std::mutex stepsMutex;
+
+	thread_local ThreadSlot* currentSlot = nullptr;
+	thread_local int currentStep = 0;
+
+	ThreadSlot& slot()
+	{
+		if (!currentSlot)
+		{
+			auto index = nextSlot.fetch_add(1, std::memory_order_relaxed);
+			currentSlot = &slots[index < MaxThreads ? index : MaxThreads - 1];
+		}
+		return *currentSlot;
+	}
+
+	int stepIndex(const char* name)
+	{
+		std::lock_guard<std::mutex> lg(stepsMutex);
+		auto count = stepCount.load();
+		for (int i = 1; i < count; i++)
+		{
+			if (std::strcmp(stepNames[i], name) == 0)
+			{
+				return i;
+			}
+		}
+		if (count == MaxSteps)
+		{
+			return 0;
+		}
+		stepNames[count] = name;
+		stepCount = count + 1;
+		return count;
+	}
+
+	StressTool::Allocations::Snapshot read(const Counter& counter)
+	{
+		return StressTool::Allocations::Snapshot{ counter.count.load(std::memory_order_relaxed), counter.bytes.load(std::memory_order_relaxed) };
+	}
+}
+
+#ifdef STRESSTOOL_TRACK_ALLOCATIONS
+
+void* operator new(std::size_t size)
+{
+	auto& s = slot();
+	s.total.count.fetch_add(1, std::memory_order_relaxed);
+	s.total.bytes.fetch_add(size, std::memory_order_relaxed);
+	s.steps[currentStep].count.fetch_add(1, std::memory_order_relaxed);
+	s.steps[currentStep].bytes.fetch_add(size, std::memory_order_relaxed);
+	if (auto ptr = std::malloc(size ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(size);
+	}
+	catch (std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	std::free(ptr);
+}
+
+bool StressTool::Allocations::enabled()
+{
+	return true;
+}
+
+#else
+
+bool StressTool::Allocations::enabled()
+{
+	return false;
+}
+
+#endif
+
+StressTool::Allocations::Snapshot StressTool::Allocations::snapshot()
+{
+	Snapshot result{ 0, 0 };
+	auto count = nextSlot.load();
+	for (int i = 0; i < count && i < MaxThreads; i++)
+	{
+		auto s = read(slots[i].total);
+		result.count += s.count;
+		result.bytes += s.bytes;
+	}
+	return result;
+}
+
+StressTool::Allocations::Snapshot StressTool::Allocations::threadSnapshot()
+{
+	return read(slot().total);
+}
+
+StressTool::Allocations::Step::Step(const char* name)
+	: _previous(currentStep)
+{
+	currentStep = stepIndex(name);
+}
+
+StressTool::Allocations::Step::~Step()
+{
+	currentStep = _previous;
+}
+
+void StressTool::Allocations::print(std::ostream& out, std::uint64_t operations)
+{
+	if (!enabled())
+	{
+		out << "allocation tracking disabled, build with STRESSTOOL_TRACK_ALLOCATIONS\n";
+		return;
+	}
+
+	auto perOperation = [operations](std::uint64_t value) {
+		return operations > 0 ? static_cast<double>(value) / operations : 0.0;
+	};
+
+	auto total = snapshot();
+	out << "allocations (" << operations << " operations)\n";
+	out << "  total : " << total.count << " allocations, " << total.bytes << " bytes\n";
+	out << "  per operation : " << perOperation(total.count) << " allocations, " << perOperation(total.bytes) << " bytes\n";
+	out << "  per step (allocations/op bytes/op)\n";
+
+	auto threads = nextSlot.load();
+	auto steps = stepCount.load();
+	for (int step = 0; step < steps; step++)
+	{
+		Snapshot stepTotal{ 0, 0 };
+		for (int i = 0; i < threads && i < MaxThreads; i++)
+		{
+			auto s = read(slots[i].steps[step]);
+			stepTotal.count += s.count;
+			stepTotal.bytes += s.bytes;
+		}
+		out << "    " << stepNames[step] << " : " << perOperation(stepTotal.count) << " " << perOperation(stepTotal.bytes) << "\n";
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+
+namespace StressTool
+{
+	namespace Allocations
+	{
+		struct Snapshot
+		{
+			std::uint64_t count;
+			std::uint64_t bytes;
+		};
+
+		/// <summary>
+		/// True if the tool was built with STRESSTOOL_TRACK_ALLOCATIONS, which replaces the global operator new and delete with counting versions.
+		/// </summary>
+		/// <remarks>
+		/// Build with msbuild /p:TrackAllocations=true to define it.
+		/// </remarks>
+		bool enabled();
+
+		/// <summary>
+		/// Number of allocations and allocated bytes since the start of the process, in all threads.
+		/// </summary>
+		Snapshot snapshot();
+
+		/// <summary>
+		/// Number of allocations and allocated bytes since the start of the calling thread.
+		/// </summary>
+		Snapshot threadSnapshot();
+
+		/// <summary>
+		/// Attributes the allocations of the calling thread to a scenario step until destroyed.
+		/// </summary>
+		/// <remarks>
+		/// Steps nest: the previous step of the thread is restored on destruction.
+		/// Allocations made by other threads (library network threads for instance) while the step runs are not attributed to it.
+		/// </remarks>
+		class Step
+		{
+		public:
+			/// <param name="name">Name of the step. Must be a string literal, at most 63 different steps are tracked.</param>
+			Step(const char* name);
+			~Step();
+
+			Step(const Step&) = delete;
+			Step& operator=(const Step&) = delete;
+
+		private:
+			int _previous;
+		};
+
+		/// <summary>
+		/// Prints allocations per completed operation, in total and for each scenario step.
+		/// </summary>
+		void print(std::ostream& out, std::uint64_t operations);
+	}
+}
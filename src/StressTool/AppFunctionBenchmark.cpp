@@ -0,0 +1,191 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "stormancer/RPC/Service.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+namespace
+{
+	struct AppFunctionResult
+	{
+		StressTool::Result result;
+		//Number of hosts that answered to the app function.
+		std::size_t hosts;
+	};
+
+	pplx::task<AppFunctionResult> callAppFunction(std::shared_ptr<Stormancer::Scene> scene)
+	{
+		auto timer = std::make_shared<Timer>();
+		auto rpc = scene->dependencyResolver().resolve<Stormancer::RpcService>();
+
+		timer->start();
+		return rpc->rpc<std::vector<int>>("Test.TestAppGlobalFunction").then([timer](pplx::task<std::vector<int>> t) {
+			AppFunctionResult r;
+			r.result.duration = timer->getElapsedTimeInMilliSec();
+			r.hosts = 0;
+			try
+			{
+				r.hosts = t.get().size();
+				r.result.success = true;
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				r.result.success = false;
+			}
+			return r;
+		});
+	}
+
+	struct Phase
+	{
+		std::vector<AppFunctionResult> results;
+		double elapsed = 0;
+	};
+
+	//Calls the app function at rate calls/s for duration seconds, round robin over the scenes.
+	Phase measure(const std::vector<std::shared_ptr<Stormancer::Scene>>& scenes, double rate, double duration)
+	{
+		std::vector<pplx::task<AppFunctionResult>> tasks;
+		tasks.reserve(static_cast<std::size_t>(rate * duration));
+
+		StressTool::Pacer pacer(rate);
+		Timer timer;
+		timer.start();
+		for (std::size_t i = 0; timer.getElapsedTimeInSec() < duration; i++)
+		{
+			pacer.wait();
+			tasks.push_back(callAppFunction(scenes[i % scenes.size()]));
+		}
+		Phase phase;
+		phase.results = pplx::when_all(tasks.begin(), tasks.end()).get();
+		timer.stop();
+		phase.elapsed = timer.getElapsedTimeInSec();
+		return phase;
+	}
+
+	//Prints and records the results of a phase under metric, and returns their statistics.
+	StressTool::Stats report(const std::string& metric, const std::string& name, const Phase& phase, double rate)
+	{
+		//Group by number of responding hosts, a partial answer during a cluster change must not be mixed with full answers.
+		std::vector<StressTool::Result> all;
+		std::map<std::size_t, std::vector<StressTool::Result>> byHosts;
+		for (auto& r : phase.results)
+		{
+			all.push_back(r.result);
+			if (r.result.success)
+			{
+				byHosts[r.hosts].push_back(r.result);
+			}
+		}
+
+		auto s = StressTool::stats(all);
+		StressTool::addCompletedOperations(s.count);
+		StressTool::RunReport::record(metric, all);
+		StressTool::RunReport::setCounter(metric + ".achievedRate", phase.results.size() / phase.elapsed);
+
+		std::cout << name << "\n";
+		std::cout << "offered rate : " << rate << " calls/s\n";
+		std::cout << "achieved rate: " << phase.results.size() / phase.elapsed << " calls/s\n";
+		StressTool::print(std::cout, s);
+		for (auto& group : byHosts)
+		{
+			auto groupStats = StressTool::stats(group.second);
+			std::cout << "hosts=" << group.first << " calls=" << groupStats.count << " p50=" << groupStats.p50 << "ms p90=" << groupStats.p90 << "ms p99=" << groupStats.p99 << "ms max=" << groupStats.max << "ms\n";
+		}
+		return s;
+	}
+}
+
+int StressTool::runAppFunctionBenchmark(const Options& options)
+{
+	auto nbClients = options.getInt("clients", 4);
+	auto rate = options.getDouble("rate", 50);
+	auto duration = options.getDouble("duration", 30);
+	//Empty scenes created on the host of test-scene after a baseline run, scenes.count must not slow down as they grow.
+	auto loadScenes = options.getInt("scenes", 0);
+	auto label = options.getString("label", "");
+
+	ConfigurationTemplate().install();
+	//Connect all clients to the test scene before starting to measure.
+	std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>> connections;
+	for (int i = 0; i < nbClients; i++)
+	{
+		connections.push_back(Clients::login(i).then([](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene("test-scene");
+		}));
+	}
+	std::vector<std::shared_ptr<Stormancer::Scene>> scenes;
+	for (auto& scene : Clients::waitConnections(connections))
+	{
+		if (scene)
+		{
+			scenes.push_back(scene);
+		}
+	}
+	std::cout << "connected " << scenes.size() << "/" << nbClients << " clients\n";
+	auto release = [nbClients]() {
+		for (int i = 0; i < nbClients; i++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(i);
+		}
+	};
+	if (scenes.empty())
+	{
+		release();
+		return 1;
+	}
+
+	std::cout << "app function benchmark " << label << "\n";
+	if (loadScenes > 0)
+	{
+		auto rpc = scenes[0]->dependencyResolver().resolve<Stormancer::RpcService>();
+		int baselineScenes = 0;
+		int running = 0;
+		Phase baseline;
+		try
+		{
+			//Load scenes are persistent: the baseline runs with the load scenes left by previous runs, if any.
+			baselineScenes = rpc->rpc<int>("Test.CreateLoadScenes", 0).get();
+			baseline = measure(scenes, rate, duration);
+
+			Timer creation;
+			creation.start();
+			//In batches, so that each RPC completes within its timeout.
+			const int batch = 500;
+			for (int requested = 0; requested < loadScenes;)
+			{
+				requested = std::min(requested + batch, loadScenes);
+				running = rpc->rpc<int>("Test.CreateLoadScenes", requested).get();
+			}
+			std::cout << "load scenes : " << running << " running (" << loadScenes << " requested) after " << creation.getElapsedTimeInSec() << "s\n";
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << "Test.CreateLoadScenes failed: " << ex.what() << "\n";
+			release();
+			return 1;
+		}
+		RunReport::setCounter("appfunction.loadScenes", running);
+		auto loaded = measure(scenes, rate, duration);
+		release();
+
+		auto baselineStats = report("appfunction.baseline", "baseline with " + std::to_string(baselineScenes) + " load scenes", baseline, rate);
+		auto loadedStats = report("appfunction", "with " + std::to_string(running) + " load scenes", loaded, rate);
+		std::cout << "added p50 : " << loadedStats.p50 - baselineStats.p50 << "ms\n";
+		std::cout << "added p99 : " << loadedStats.p99 - baselineStats.p99 << "ms\n";
+		return 0;
+	}
+
+	auto phase = measure(scenes, rate, duration);
+	release();
+	report("appfunction", "results", phase, rate);
+	return 0;
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "Options.h"
+
+namespace StressTool
+{
+	/// <summary>
+	/// Calls the cluster wide "scenes.count" app function through Test.TestAppGlobalFunction at a fixed rate,
+	/// and reports latency percentiles grouped by the number of hosts that answered.
+	/// </summary>
+	/// <remarks>
+	/// Options: --clients (4), --rate in calls/s (50), --duration in s (30), --scenes created on the host after a baseline run, both runs being reported (0), --label (printed with the results).
+	/// </remarks>
+	int runAppFunctionBenchmark(const Options& options);
+
+	/// <summary>
+	/// Joins clients to the relay-bench scene, where each client sends entity updates at a fixed tick rate
+	/// and a scene controller relays every update to all clients. Reports delivery latency, updates/s per client and payload bytes per update.
+	/// </summary>
+	/// <remarks>
+	/// This measures a hand-written relay, not the replication plugin of test-gamesession: the sizes exclude protocol overhead.
+	/// Options: --clients (8), --entities per client (4), --tick in updates/s (20), --componentSize in bytes (32), --duration in s (30).
+	/// </remarks>
+	int runSceneRelayBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs many 2 player game sessions concurrently and reports the time from ready to GameFoundEvent,
+	/// from GameFoundEvent to connectToGameSession completion and from there to setPlayerReady completion, split between hosts and peers.
+	/// </summary>
+	/// <remarks>
+	/// Options: --sessions (50), --punchPattern (log pattern counted as a NAT punch attempt, "punch"), --label (printed with the results).
+	/// Run against a node with p2p.enableRelay set to true (deploy/default.json) and to false (deploy/bench-p2p-direct.json) to compare relay and direct connections.
+	/// </remarks>
+	int runP2PBenchmark(const Options& options);
+
+	/// <summary>
+	/// Echoes payloads of increasing sizes (powers of two) through Test.TestSameSceneS2S with a fixed number of messages in flight.
+	/// For each size, reports throughput, latency percentiles and client side allocations per message.
+	/// </summary>
+	/// <remarks>
+	/// Options: --window (16), --messages per size (1000), --minSize (16), --maxSize (262144), --maxMBPerSize (256).
+	/// </remarks>
+	int runPayloadSweepBenchmark(const Options& options);
+
+	/// <summary>
+	/// Searches the highest login rate meeting a latency and error rate SLO.
+	/// The offered rate doubles until the SLO is violated, then a binary search narrows the gap between the last passing and the first failing rate.
+	/// </summary>
+	/// <remarks>
+	/// Options: --p99 in ms (250), --maxErrorRate (0.001), --startRate (10), --maxRate (10000), --stepDuration in s (20),
+	/// --stepWarmup in s, discarded at the start of each step (2), --precision (0.05).
+	/// </remarks>
+	int runCapacityBenchmark(const Options& options);
+
+	/// <summary>
+	/// Compares two result files written with --output, and returns 1 if a metric of the candidate regressed compared to the baseline.
+	/// </summary>
+	/// <remarks>
+	/// A metric regresses if its median is larger with a one sided Mann-Whitney U test p-value under --alpha and by more than --threshold,
+	/// if the bootstrap 95% confidence interval of the p99 ratio is entirely above 1 + --threshold, or if its success rate drops by more than --maxSuccessDrop.
+	/// Options: --baseline, --candidate, --threshold (0.05), --alpha (0.01), --maxSuccessDrop (0.01), --bootstrap iterations (1000).
+	/// </remarks>
+	int runCompare(const Options& options);
+
+	/// <summary>
+	/// Measures the time, resident memory and allocations needed to create clients, with a configurator registered per client id and with the default configurator of a ConfigurationTemplate.
+	/// </summary>
+	/// <remarks>
+	/// Clients are created without connecting to the server. Options: --clients (1000), --rounds (2).
+	/// </remarks>
+	int runStartupBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs the same login and RPC echo workloads with transport encryption disabled and enabled, and reports the added latency, the throughput drop and the client CPU time per RPC.
+	/// </summary>
+	/// <remarks>
+	/// Options: --clients (8), --window of RPCs in flight per client (8), --messages per client (2000), --size of payloads in bytes (256), --rounds (2).
+	/// </remarks>
+	int runEncryptionBenchmark(const Options& options);
+
+	/// <summary>
+	/// Connects new clients to a scene rejecting them at increasing rates, and reports rejection latency, rejections/s and client (and server) memory growth.
+	/// </summary>
+	/// <remarks>
+	/// Options: --scene (rejection-test-scene, or test-connection-rejected), --reason expected in the rejection error ("reject", or "Rejected"), --login before connecting (false),
+	/// --startRate (50), --maxRate (2000), --stepDuration in s (10), --serverPid of a local server to follow its memory.
+	/// </remarks>
+	int runRejectionBenchmark(const Options& options);
+
+	/// <summary>
+	/// Ramps connections to an application with a CCU limit past the limit, holds them, then disconnects part of the admitted clients.
+	/// Reports admission, rejection and slot reuse latencies, and the highest number of concurrently connected clients. Returns 1 if it exceeded the limit by more than one,
+	/// the transient overshoot client side accounting can show when a freed slot is given to a queued client before the disconnection completes on the client.
+	/// </summary>
+	/// <remarks>
+	/// Options: --app (queue-test), --limits configuration file of the application, or --limit (1) and --queue (1000) configured on the server,
+	/// --clients (4 x limit), --rate of arrivals, 0 for all at once (0),
+	/// --hold in s (10), --churn fraction of admitted clients disconnected (0.5), --reuseTimeout in s (30).
+	/// </remarks>
+	int runCcuBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs a NetworkProxy between clients and a local server until stopped, or for --duration seconds.
+	/// </summary>
+	/// <remarks>
+	/// Options: --profile (mobile4g), --latency, --jitter, --latencySpread, --loss, --reorder, --bandwidth overriding the profile,
+	/// --udpListen (30110), --udpTarget (30100), --tcpListen (80), --tcpTarget (8081), --target host (127.0.0.1), --duration in s (0), --report interval in s (10).
+	/// </remarks>
+	int runProxy(const Options& options);
+
+	/// <summary>
+	/// Compares MainThreadActionDispatcher and LockFreeActionDispatcher: 1 to --maxProducers threads post actions while the calling thread runs update(5ms).
+	/// Reports posts/s and the latency from post to execution.
+	/// </summary>
+	/// <remarks>
+	/// Options: --posts per run (1000000), --maxProducers (64), --capacity of the lock-free queue (65536), --drainBatch (64).
+	/// </remarks>
+	int runDispatcherBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs login, scene connection and client release cycles for hours, sampling resident memory, open handles and threads,
+	/// and fits a trend line to each. Returns 1 if a resource grows with the iterations.
+	/// </summary>
+	/// <remarks>
+	/// A resource leaks if the 95% confidence interval of its growth per iteration, fitted on batch means, is entirely above its tolerance.
+	/// Options: --duration in s (3600), --clients cycling concurrently (4), --scene (test-scene), --warmup iterations before sampling (500),
+	/// --sampleEvery iterations (100), --batches of samples averaged before the fit (10), --report interval in s (60), --rssTolerance in bytes per iteration (256), --handleTolerance (0), --threadTolerance (0).
+	/// </remarks>
+	int runSoakBenchmark(const Options& options);
+
+	/// <summary>
+	/// Party leaders create parties and invitation codes while the other members redeem them concurrently, then part of the members leave and rejoin with the next code.
+	/// Reports party creation, code creation, join and leave latencies, and party operations/s.
+	/// </summary>
+	/// <remarks>
+	/// joinPartyByInvitationCode resolves the code and joins in a single call: the join latency includes code resolution.
+	/// Options: --parties (50), --size including the leader (4), --rounds of code creation and joins per party (10),
+	/// --churn fraction of the members leaving after each round (0.5), --rate of parties started per second, 0 for all at once (0).
+	/// </remarks>
+	int runPartyChurnBenchmark(const Options& options);
+
+	/// <summary>
+	/// Subscribes clients to PeerConfigurationApi, updates the peer configuration through the Test.UpdatePeerConfiguration route, and reports the delivery latency
+	/// distribution from that call, the time until the last client received the update and the configuration bytes received by each client.
+	/// </summary>
+	/// <remarks>
+	/// The update is the first configuration received by a client that contains the revision sent to the route.
+	/// The route is only enabled when the application configuration sets stressTool.adminKey and stressTool.peerConfigurationSection, as configs/test-peerconfig.json does.
+	/// Options: --clients (1000), --rate of logins per second, 0 for all at once (200), --size of the padding of the update in bytes (1024), --adminKey (empty), --timeout in s (60).
+	/// </remarks>
+	int runPeerConfigurationBenchmark(const Options& options);
+
+	/// <summary>
+	/// Calls the UsersTestController RPCs making the server send a request to the calling user, handled by the client on routes a, b and c.
+	/// Reports the client->server->client->server round trip and calls/s per route, and for b and c the time to the client handler and back.
+	/// </summary>
+	/// <remarks>
+	/// Options: --clients (10), --rate of calls per second over all clients (100), --duration in s (30), --route a, b, c or all (all).
+	/// </remarks>
+	int runServerRequestBenchmark(const Options& options);
+
+	/// <summary>
+	/// Reads the Test.TestS2SStream stream, merged on the server from the S2S scenes, slower than it is produced, once through a bounded merge buffer
+	/// and once through an unbounded one. Reports items/s and the growth of the server resident memory of each run.
+	/// </summary>
+	/// <remarks>
+	/// The unbounded merge requires the stressTool.adminKey of the application configuration, and the server limits each stream to 64MB.
+	/// Options: --count of items per producer (2000), --size of items in bytes (1024), --capacity of the bounded server merge buffer, 0 to only run the unbounded one (64),
+	/// --adminKey enabling the unbounded run (empty), --itemDelay processing time per item in ms (2), --serverPid of a local server, --sampleInterval in s (1).
+	/// </remarks>
+	int runSlowConsumerBenchmark(const Options& options);
+
+	/// <summary>
+	/// Logs in clients all at once, alternately connecting directly to the server and through a MetadataCache shared by all clients,
+	/// and reports the time until the last client is connected, login latency and the HTTP requests that reached the server.
+	/// </summary>
+	/// <remarks>
+	/// Both variants connect to the server endpoint itself, ignoring --metadataCache.
+	/// Options: --clients (1000), --rounds (2), --metadataCacheTtl of cached responses in s (30).
+	/// </remarks>
+	int runMassConnectBenchmark(const Options& options);
+}
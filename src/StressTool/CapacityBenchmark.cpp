@@ -0,0 +1,139 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "Worker.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	struct Slo
+	{
+		double p99;
+		double maxErrorRate;
+	};
+
+	struct StepResult
+	{
+		double offeredRate;
+		double achievedRate;
+		StressTool::Stats stats;
+		double errorRate;
+		bool passed;
+	};
+
+	StepResult measureStep(double rate, double duration, double warmup, const Slo& slo, int& nextId)
+	{
+		std::vector<pplx::task<StressTool::Result>> tasks;
+		std::size_t firstMeasured = 0;
+
+		StressTool::Pacer pacer(rate);
+		Timer timer;
+		timer.start();
+		for (auto elapsed = 0.0; elapsed < warmup + duration; elapsed = timer.getElapsedTimeInSec())
+		{
+			pacer.wait();
+			//Operations started during warm up run, but their results are discarded.
+			if (elapsed < warmup)
+			{
+				firstMeasured = tasks.size() + 1;
+			}
+			auto id = nextId++;
+			tasks.push_back(pplx::create_task([id]() {
+				StressTool::ConnectionWorker worker;
+				return worker.run(id);
+			}));
+		}
+		auto results = pplx::when_all(tasks.begin(), tasks.end()).get();
+		results.erase(results.begin(), results.begin() + std::min(firstMeasured, results.size()));
+
+		StepResult step;
+		step.offeredRate = rate;
+		step.stats = StressTool::stats(results);
+		step.achievedRate = step.stats.count / duration;
+		step.errorRate = 1 - step.stats.successRate;
+		step.passed = !results.empty() && step.stats.p99 < slo.p99 && step.errorRate < slo.maxErrorRate;
+		StressTool::addCompletedOperations(step.stats.count);
+		return step;
+	}
+
+	void printStep(const StepResult& step)
+	{
+		std::cout << std::setw(10) << step.offeredRate << std::setw(10) << step.achievedRate
+			<< std::setw(10) << step.stats.p50 << std::setw(10) << step.stats.p99
+			<< std::setw(10) << step.errorRate * 100 << "%" << (step.passed ? "  ok" : "  SLO violated") << "\n";
+	}
+}
+
+int StressTool::runCapacityBenchmark(const Options& options)
+{
+	Slo slo;
+	slo.p99 = options.getDouble("p99", 250);
+	slo.maxErrorRate = options.getDouble("maxErrorRate", 0.001);
+	auto rate = options.getDouble("startRate", 10);
+	auto maxRate = options.getDouble("maxRate", 10000);
+	auto stepDuration = options.getDouble("stepDuration", 20);
+	auto warmup = options.getDouble("stepWarmup", 2);
+	//The search stops when the gap between the best passing rate and the lowest failing rate is under this fraction.
+	auto precision = options.getDouble("precision", 0.05);
+
+	std::cout << "capacity search for login, SLO: p99 < " << slo.p99 << "ms and error rate < " << slo.maxErrorRate * 100 << "%\n";
+	std::cout << std::setw(10) << "offered/s" << std::setw(10) << "achieved" << std::setw(10) << "p50(ms)" << std::setw(10) << "p99(ms)" << std::setw(10) << "errors" << "\n";
+
+	std::vector<StepResult> curve;
+	int nextId = 0;
+	double bestPassing = 0;
+	double lowestFailing = 0;
+
+	//Double the rate until the SLO is violated, then binary search between the last passing and the first failing rate.
+	while (rate <= maxRate)
+	{
+		auto step = measureStep(rate, stepDuration, warmup, slo, nextId);
+		curve.push_back(step);
+		printStep(step);
+
+		if (step.passed)
+		{
+			bestPassing = rate;
+		}
+		else
+		{
+			lowestFailing = rate;
+		}
+
+		if (lowestFailing == 0)
+		{
+			rate *= 2;
+		}
+		else if (lowestFailing - bestPassing <= precision * std::max(bestPassing, 1.0))
+		{
+			break;
+		}
+		else
+		{
+			rate = (bestPassing + lowestFailing) / 2;
+		}
+	}
+
+	RunReport::setCounter("capacity.maxSustainableRate", bestPassing);
+	for (auto& step : curve)
+	{
+		//Binary search steps have fractional rates: keep the decimals, so that they don't share a counter with another step.
+		std::ostringstream name;
+		name << "capacity." << step.offeredRate << ".p99";
+		RunReport::setCounter(name.str(), step.stats.p99);
+	}
+
+	std::cout << "max sustainable login rate : " << bestPassing << "/s";
+	if (lowestFailing == 0)
+	{
+		std::cout << " (SLO still met at --maxRate)";
+	}
+	std::cout << "\n";
+	return bestPassing > 0 ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "Limits/connectionQueue.hpp"
+#include "stormancer/cpprestsdk/cpprest/json.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	namespace json = Stormancer::web::json;
+	namespace conversions = Stormancer::utility::conversions;
+
+	enum class AgentState
+	{
+		Queued,
+		Connected,
+		Rejected,
+		Disconnected
+	};
+
+	struct CcuState
+	{
+		std::mutex mutex;
+		std::vector<AgentState> agents;
+		std::vector<StressTool::Result> admissions;
+		std::vector<StressTool::Result> rejections;
+		std::vector<StressTool::Result> reuses;
+		//Times at which slots were freed by a disconnection and not yet taken by a queued client.
+		std::deque<Clock::time_point> freedSlots;
+		std::atomic<int> connected{ 0 };
+		//Set before clients still in queue are released, so that they aren't counted as rejected.
+		bool stopping = false;
+	};
+
+	void runAgent(int id, std::shared_ptr<CcuState> state)
+	{
+		auto timer = std::make_shared<Timer>();
+		timer->start();
+		StressTool::Clients::login(id).then([id, state, timer](pplx::task<std::shared_ptr<Stormancer::IClient>> t) {
+			StressTool::Result r;
+			r.duration = timer->getElapsedTimeInMilliSec();
+			r.success = true;
+			auto now = Clock::now();
+
+			std::lock_guard<std::mutex> lg(state->mutex);
+			try
+			{
+				t.get();
+				state->agents[id] = AgentState::Connected;
+				state->connected++;
+				state->admissions.push_back(r);
+				if (!state->freedSlots.empty())
+				{
+					StressTool::Result reuse;
+					reuse.success = true;
+					reuse.duration = std::chrono::duration<double, std::milli>(now - state->freedSlots.front()).count();
+					state->freedSlots.pop_front();
+					state->reuses.push_back(reuse);
+				}
+			}
+			catch (std::exception&)
+			{
+				if (!state->stopping)
+				{
+					state->agents[id] = AgentState::Rejected;
+					state->rejections.push_back(r);
+				}
+			}
+		});
+	}
+
+	void disconnectAgent(int id, std::shared_ptr<CcuState> state)
+	{
+		Stormancer::IClientFactory::GetClient(id)->disconnect().then([id, state](pplx::task<void> t) {
+			try
+			{
+				t.get();
+			}
+			catch (std::exception&)
+			{
+				//Continuations must catch all errors.
+			}
+			std::lock_guard<std::mutex> lg(state->mutex);
+			state->agents[id] = AgentState::Disconnected;
+			state->connected--;
+			state->freedSlots.push_back(Clock::now());
+		});
+	}
+
+	struct Occupancy
+	{
+		int limit;
+		int maxConnected = 0;
+		std::uint64_t samples = 0;
+		std::uint64_t samplesAboveLimit = 0;
+
+		void sample(const CcuState& state)
+		{
+			auto connected = state.connected.load();
+			maxConnected = std::max(maxConnected, connected);
+			samples++;
+			if (connected > limit)
+			{
+				samplesAboveLimit++;
+			}
+		}
+	};
+
+	//Reads limits.connections from the configuration file of the application, such as configs/test-queue.json.
+	bool readLimits(const std::string& path, int& max, int& queue)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "can't open " << path << "\n";
+			return false;
+		}
+		std::stringstream content;
+		content << file.rdbuf();
+		try
+		{
+			auto connections = json::value::parse(conversions::to_string_t(content.str())).at(U("limits")).at(U("connections"));
+			max = connections.at(U("max")).as_integer();
+			queue = connections.at(U("queue")).as_integer();
+			return true;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << "can't read limits.connections from " << path << " : " << ex.what() << "\n";
+			return false;
+		}
+	}
+
+	void print(const char* name, const std::vector<StressTool::Result>& results)
+	{
+		auto s = StressTool::stats(results);
+		std::cout << name << " n=" << s.count << " p50=" << s.p50 << "ms p90=" << s.p90 << "ms p99=" << s.p99 << "ms max=" << s.max << "ms\n";
+	}
+}
+
+int StressTool::runCcuBenchmark(const Options& options)
+{
+	//Must match the limits configured on the server, which aren't exposed to clients: read them from the configuration file of the application,
+	//or give them with --limit and --queue. The defaults are those of configs/test-queue.json.
+	auto limit = 1;
+	auto queueSize = 1000;
+	auto limitsPath = options.getString("limits", "");
+	if (!limitsPath.empty() && !readLimits(limitsPath, limit, queueSize))
+	{
+		return 2;
+	}
+	limit = options.getInt("limit", limit);
+	queueSize = options.getInt("queue", queueSize);
+	auto nbClients = options.getInt("clients", limit * 4);
+	//0 starts all clients at once.
+	auto rate = options.getDouble("rate", 0);
+	auto hold = options.getDouble("hold", 10);
+	auto churn = options.getDouble("churn", 0.5);
+	auto reuseTimeout = options.getDouble("reuseTimeout", 30);
+
+	ConfigurationTemplate()
+		.application(options.getString("app", "queue-test"))
+		.addPlugin<Stormancer::Limits::ConnectionQueuePlugin>()
+		.install();
+
+	auto state = std::make_shared<CcuState>();
+	state->agents.assign(nbClients, AgentState::Queued);
+	Occupancy occupancy;
+	occupancy.limit = limit;
+
+	auto sampleFor = [&occupancy, state](double seconds, std::function<bool()> done) {
+		Timer timer;
+		timer.start();
+		while (timer.getElapsedTimeInSec() < seconds && !done())
+		{
+			occupancy.sample(*state);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	};
+
+	//Arrivals, then hold: clients beyond the limit wait in the connection queue.
+	std::unique_ptr<Pacer> pacer(rate > 0 ? new Pacer(rate) : nullptr);
+	for (int i = 0; i < nbClients; i++)
+	{
+		if (pacer)
+		{
+			pacer->wait();
+		}
+		runAgent(i, state);
+		occupancy.sample(*state);
+	}
+	sampleFor(hold, []() { return false; });
+
+	//Disconnect part of the admitted clients, and measure how fast queued clients take the freed slots.
+	std::vector<int> connectedIds;
+	std::size_t queued = 0;
+	{
+		std::lock_guard<std::mutex> lg(state->mutex);
+		for (int i = 0; i < nbClients; i++)
+		{
+			if (state->agents[i] == AgentState::Connected)
+			{
+				connectedIds.push_back(i);
+			}
+			else if (state->agents[i] == AgentState::Queued)
+			{
+				queued++;
+			}
+		}
+	}
+	auto toDisconnect = static_cast<std::size_t>(std::ceil(churn * connectedIds.size()));
+	for (std::size_t i = 0; i < toDisconnect; i++)
+	{
+		disconnectAgent(connectedIds[i], state);
+	}
+	auto expectedReuses = std::min(toDisconnect, queued);
+	sampleFor(reuseTimeout, [state, expectedReuses]() {
+		std::lock_guard<std::mutex> lg(state->mutex);
+		return state->reuses.size() >= expectedReuses;
+	});
+
+	{
+		std::lock_guard<std::mutex> lg(state->mutex);
+		state->stopping = true;
+	}
+	for (int i = 0; i < nbClients; i++)
+	{
+		Stormancer::IClientFactory::ReleaseClient(i);
+	}
+
+	std::lock_guard<std::mutex> lg(state->mutex);
+	addCompletedOperations(state->admissions.size() + state->rejections.size());
+	RunReport::record("ccu.admission", state->admissions);
+	RunReport::record("ccu.rejection", state->rejections);
+	RunReport::record("ccu.slotReuse", state->reuses);
+	RunReport::setCounter("ccu.limit", limit);
+	RunReport::setCounter("ccu.queue", queueSize);
+	RunReport::setCounter("ccu.maxConcurrent", occupancy.maxConnected);
+	RunReport::setCounter("ccu.timeAboveLimit", occupancy.samples ? static_cast<double>(occupancy.samplesAboveLimit) / occupancy.samples : 0);
+
+	//With all the clients arriving at once, those beyond the limit and the queue are rejected.
+	auto expectedRejections = std::max(0, nbClients - limit - queueSize);
+	std::cout << "ccu limit benchmark, " << nbClients << " clients for a limit of " << limit << " and a queue of " << queueSize << (rate > 0 ? "" : ", all arriving at once") << "\n";
+	if (expectedRejections == 0)
+	{
+		std::cout << "no rejection expected: the queue holds all the clients beyond the limit (see configs/test-queue-small.json)\n";
+	}
+	print("admission  ", state->admissions);
+	print("rejection  ", state->rejections);
+	print("slot reuse ", state->reuses);
+	std::cout << "slots reused       : " << state->reuses.size() << " of " << expectedReuses << " expected\n";
+	//Connections are counted when login completes on the client and released when disconnect completes on the client,
+	//so a slot freed on the server and already given to a queued client can show up as a transient overshoot of one, which doesn't fail the run.
+	const int tolerance = 1;
+	std::cout << "max concurrent     : " << occupancy.maxConnected << " (limit " << limit << ", " << tolerance << " tolerated for client side accounting)\n";
+	std::cout << "time above limit   : " << (occupancy.samples ? 100.0 * occupancy.samplesAboveLimit / occupancy.samples : 0) << "% of samples\n";
+	return occupancy.maxConnected > limit + tolerance ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+#include "Clients.h"
+//Provides APIs related to authentication & user management.
+#include "Users/Users.hpp"
+#include <iostream>
+
+pplx::task<std::shared_ptr<Stormancer::IClient>> StressTool::Clients::login(int id)
+{
+	auto client = Stormancer::IClientFactory::GetClient(id);
+
+	auto users = client->dependencyResolver().resolve<Stormancer::Users::UsersApi>();
+	users->getCredentialsCallback = []() {
+		Stormancer::Users::AuthParameters authParameters;
+		authParameters.type = "ephemeral";
+		return pplx::task_from_result(authParameters);
+	};
+
+	return users->login().then([client]() {
+		return client;
+	});
+}
+
+std::vector<std::shared_ptr<Stormancer::Scene>> StressTool::Clients::waitConnections(std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>>& connections)
+{
+	std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>> guarded;
+	for (auto& connection : connections)
+	{
+		guarded.push_back(connection.then([](pplx::task<std::shared_ptr<Stormancer::Scene>> t) {
+			try
+			{
+				return t.get();
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				return std::shared_ptr<Stormancer::Scene>();
+			}
+		}));
+	}
+	return pplx::when_all(guarded.begin(), guarded.end()).get();
+}
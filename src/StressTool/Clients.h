@@ -0,0 +1,30 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "stormancer/IClientFactory.h"
+
+namespace StressTool
+{
+	namespace Clients
+	{
+		/// <summary>
+		/// Logs in the client of id <c>id</c> using ephemeral authentication.
+		/// </summary>
+		/// <remarks>
+		/// The client is created with the configuration installed with ConfigurationTemplate::install().
+		/// </remarks>
+		/// <param name="id">Id of the client in IClientFactory.</param>
+		/// <returns>A task that completes with the authenticated client.</returns>
+		pplx::task<std::shared_ptr<Stormancer::IClient>> login(int id);
+
+		/// <summary>
+		/// Waits for the scene connections of several clients.
+		/// </summary>
+		/// <remarks>
+		/// A failed connection is reported and leaves a null scene at its index, so that the run continues with the clients that connected.
+		/// </remarks>
+		/// <param name="connections">Connection tasks, usually one per client id.</param>
+		/// <returns>The scenes, in the order of the connection tasks.</returns>
+		std::vector<std::shared_ptr<Stormancer::Scene>> waitConnections(std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>>& connections);
+	}
+}
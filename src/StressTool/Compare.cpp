@@ -0,0 +1,269 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Stats.h"
+#include "stormancer/cpprestsdk/cpprest/json.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	namespace json = Stormancer::web::json;
+	namespace conversions = Stormancer::utility::conversions;
+
+	bool load(const std::string& path, json::value& result)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "can't open " << path << "\n";
+			return false;
+		}
+		std::stringstream content;
+		content << file.rdbuf();
+		try
+		{
+			result = json::value::parse(conversions::to_string_t(content.str()));
+			return true;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << "can't parse " << path << " : " << ex.what() << "\n";
+			return false;
+		}
+	}
+
+	std::vector<double> samples(const json::value& metric)
+	{
+		std::vector<double> result;
+		for (auto& v : metric.at(U("samples")).as_array())
+		{
+			result.push_back(v.as_double());
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// One sided Mann-Whitney U test, using the normal approximation with tie correction.
+	/// </summary>
+	/// <returns>The p-value of the hypothesis "candidate values are larger than baseline values".</returns>
+	double mannWhitneyGreater(const std::vector<double>& baseline, const std::vector<double>& candidate)
+	{
+		auto n1 = static_cast<double>(candidate.size());
+		auto n2 = static_cast<double>(baseline.size());
+		if (n1 == 0 || n2 == 0)
+		{
+			return 1;
+		}
+
+		//(value, is candidate)
+		std::vector<std::pair<double, bool>> all;
+		all.reserve(candidate.size() + baseline.size());
+		for (auto v : candidate)
+		{
+			all.emplace_back(v, true);
+		}
+		for (auto v : baseline)
+		{
+			all.emplace_back(v, false);
+		}
+		std::sort(all.begin(), all.end(), [](const std::pair<double, bool>& a, const std::pair<double, bool>& b) { return a.first < b.first; });
+
+		double candidateRanks = 0;
+		double tieCorrection = 0;
+		for (std::size_t i = 0; i < all.size();)
+		{
+			auto j = i;
+			while (j < all.size() && all[j].first == all[i].first)
+			{
+				j++;
+			}
+			//Tied values get the average of their ranks (ranks start at 1).
+			auto rank = (i + 1 + j) / 2.0;
+			for (auto k = i; k < j; k++)
+			{
+				if (all[k].second)
+				{
+					candidateRanks += rank;
+				}
+			}
+			auto t = static_cast<double>(j - i);
+			tieCorrection += t * t * t - t;
+			i = j;
+		}
+
+		auto n = n1 + n2;
+		auto u = candidateRanks - n1 * (n1 + 1) / 2;
+		auto mean = n1 * n2 / 2;
+		auto sigma = std::sqrt(n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1))));
+		if (sigma == 0)
+		{
+			return 1;
+		}
+		auto z = (u - mean - 0.5) / sigma;
+		return 0.5 * std::erfc(z / std::sqrt(2.0));
+	}
+
+	double percentileOf(std::vector<double> values, double p)
+	{
+		std::sort(values.begin(), values.end());
+		return StressTool::percentile(values, p);
+	}
+
+	/// <summary>
+	/// Bootstrap 95% confidence interval of the ratio candidate p / baseline p for percentile p.
+	/// </summary>
+	std::pair<double, double> bootstrapPercentileRatio(const std::vector<double>& baseline, const std::vector<double>& candidate, double p, int iterations)
+	{
+		//Fixed seed: comparing the same files twice gives the same result.
+		std::mt19937 random(42);
+		std::vector<double> ratios;
+		std::vector<double> b(baseline.size());
+		std::vector<double> c(candidate.size());
+		std::uniform_int_distribution<std::size_t> pickBaseline(0, baseline.size() - 1);
+		std::uniform_int_distribution<std::size_t> pickCandidate(0, candidate.size() - 1);
+		for (int i = 0; i < iterations; i++)
+		{
+			for (auto& v : b)
+			{
+				v = baseline[pickBaseline(random)];
+			}
+			for (auto& v : c)
+			{
+				v = candidate[pickCandidate(random)];
+			}
+			auto rank = [p](std::vector<double>& values) {
+				auto index = std::min(values.size() - 1, static_cast<std::size_t>(std::ceil(p / 100 * values.size())) - 1);
+				std::nth_element(values.begin(), values.begin() + index, values.end());
+				return values[index];
+			};
+			auto basePercentile = rank(b);
+			if (basePercentile > 0)
+			{
+				ratios.push_back(rank(c) / basePercentile);
+			}
+		}
+		if (ratios.empty())
+		{
+			return { 1, 1 };
+		}
+		std::sort(ratios.begin(), ratios.end());
+		return { StressTool::percentile(ratios, 2.5), StressTool::percentile(ratios, 97.5) };
+	}
+}
+
+int StressTool::runCompare(const Options& options)
+{
+	auto baselinePath = options.getString("baseline", "");
+	auto candidatePath = options.getString("candidate", "");
+	//Relative increase of a latency considered as a regression.
+	auto threshold = options.getDouble("threshold", 0.05);
+	auto alpha = options.getDouble("alpha", 0.01);
+	auto maxSuccessDrop = options.getDouble("maxSuccessDrop", 0.01);
+	auto iterations = options.getInt("bootstrap", 1000);
+
+	json::value baseline;
+	json::value candidate;
+	if (baselinePath.empty() || candidatePath.empty())
+	{
+		std::cout << "usage: StressTool compare --baseline=<result.json> --candidate=<result.json> [--threshold=0.05] [--alpha=0.01]\n";
+		return 2;
+	}
+	if (!load(baselinePath, baseline) || !load(candidatePath, candidate))
+	{
+		return 2;
+	}
+
+	auto regressions = 0;
+	//Reports that parse but don't have the expected shape are rejected like unreadable ones.
+	try
+	{
+		std::cout << std::setw(24) << std::left << "metric" << std::right
+			<< std::setw(12) << "base p50" << std::setw(12) << "cand p50" << std::setw(12) << "base p99" << std::setw(12) << "cand p99"
+			<< std::setw(12) << "MWU p" << std::setw(22) << "p99 ratio 95% CI" << "\n";
+
+		auto& candidateMetrics = candidate.at(U("metrics")).as_object();
+		for (auto& m : baseline.at(U("metrics")).as_object())
+		{
+			auto name = conversions::to_utf8string(m.first);
+			auto it = candidateMetrics.find(m.first);
+			if (it == candidateMetrics.end())
+			{
+				//A benchmark that stopped producing its metric must not pass the gate.
+				std::cout << std::setw(24) << std::left << name << std::right << " missing in candidate REGRESSION(missing)\n";
+				regressions++;
+				continue;
+			}
+
+			auto baseSamples = samples(m.second);
+			auto candidateSamples = samples(it->second);
+			if (baseSamples.empty() || candidateSamples.empty())
+			{
+				auto lost = !baseSamples.empty();
+				std::cout << std::setw(24) << std::left << name << std::right << " no samples" << (lost ? " in candidate REGRESSION(missing)" : "") << "\n";
+				if (lost)
+				{
+					regressions++;
+				}
+				continue;
+			}
+
+			auto baseMedian = percentileOf(baseSamples, 50);
+			auto candidateMedian = percentileOf(candidateSamples, 50);
+			auto pValue = mannWhitneyGreater(baseSamples, candidateSamples);
+			auto ci = bootstrapPercentileRatio(baseSamples, candidateSamples, 99, iterations);
+			auto successDrop = m.second.at(U("successRate")).as_double() - it->second.at(U("successRate")).as_double();
+
+			std::vector<std::string> reasons;
+			if (pValue < alpha && candidateMedian > baseMedian * (1 + threshold))
+			{
+				reasons.push_back("median");
+			}
+			if (ci.first > 1 + threshold)
+			{
+				reasons.push_back("p99");
+			}
+			if (successDrop > maxSuccessDrop)
+			{
+				reasons.push_back("success rate");
+			}
+
+			std::cout << std::setw(24) << std::left << name << std::right
+				<< std::setw(12) << baseMedian << std::setw(12) << candidateMedian
+				<< std::setw(12) << percentileOf(baseSamples, 99) << std::setw(12) << percentileOf(candidateSamples, 99)
+				<< std::setw(12) << pValue << std::setw(10) << ci.first << " - " << std::setw(8) << ci.second;
+			for (auto& reason : reasons)
+			{
+				std::cout << " REGRESSION(" << reason << ")";
+			}
+			std::cout << "\n";
+			if (!reasons.empty())
+			{
+				regressions++;
+			}
+		}
+
+		//Counters are printed for information, their meaning depends on the benchmark.
+		auto& candidateCounters = candidate.at(U("counters")).as_object();
+		for (auto& c : baseline.at(U("counters")).as_object())
+		{
+			auto it = candidateCounters.find(c.first);
+			if (it != candidateCounters.end())
+			{
+				std::cout << conversions::to_utf8string(c.first) << " : " << c.second.as_double() << " -> " << it->second.as_double() << "\n";
+			}
+		}
+	}
+	catch (json::json_exception& ex)
+	{
+		std::cout << "malformed report: " << ex.what() << "\n";
+		return 2;
+	}
+
+	std::cout << regressions << " regression(s)\n";
+	return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+#include "ConfigurationTemplate.h"
+//Provides APIs related to authentication & user management.
+#include "Users/Users.hpp"
+
+constexpr const char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
+constexpr const char* Account = "tests";
+constexpr const char* Application = "test";
+
+namespace
+{
+	std::string& endpointOverride()
+	{
+		static std::string endpoint;
+		return endpoint;
+	}
+}
+
+StressTool::ConfigurationTemplate::ConfigurationTemplate(bool users)
+	: _endpoint(defaultEndpoint())
+	, _account(Account)
+	, _application(Application)
+{
+	if (users)
+	{
+		addPlugin<Stormancer::Users::UsersPlugin>();
+	}
+}
+
+StressTool::ConfigurationTemplate& StressTool::ConfigurationTemplate::application(const std::string& name)
+{
+	_application = name;
+	return *this;
+}
+
+StressTool::ConfigurationTemplate& StressTool::ConfigurationTemplate::endpoint(const std::string& url)
+{
+	_endpoint = url;
+	return *this;
+}
+
+void StressTool::ConfigurationTemplate::setDefaultEndpoint(const std::string& url)
+{
+	endpointOverride() = url;
+}
+
+std::string StressTool::ConfigurationTemplate::defaultEndpoint()
+{
+	return endpointOverride().empty() ? ServerEndpoint : endpointOverride();
+}
+
+std::string StressTool::ConfigurationTemplate::serverEndpoint()
+{
+	return ServerEndpoint;
+}
+
+StressTool::ConfigurationTemplate& StressTool::ConfigurationTemplate::configure(std::function<void(Stormancer::Configuration&)> setting)
+{
+	_settings.push_back(setting);
+	return *this;
+}
+
+std::shared_ptr<Stormancer::Configuration> StressTool::ConfigurationTemplate::create() const
+{
+	auto config = Stormancer::Configuration::create(_endpoint, _account, _application);
+	for (auto& plugin : _plugins)
+	{
+		config->addPlugin(plugin());
+	}
+	for (auto& setting : _settings)
+	{
+		setting(*config);
+	}
+	return config;
+}
+
+void StressTool::ConfigurationTemplate::install() const
+{
+	//The configurator only reads this snapshot: the names, plugin factories and settings are shared, while each client gets the configuration and plugins it owns.
+	auto snapshot = std::make_shared<const ConfigurationTemplate>(*this);
+	Stormancer::IClientFactory::SetDefaultConfigurator([snapshot](size_t) {
+		return snapshot->create();
+	});
+}
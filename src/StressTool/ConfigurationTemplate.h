@@ -0,0 +1,81 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "stormancer/IClientFactory.h"
+
+namespace StressTool
+{
+	/// <summary>
+	/// Client configuration built once and stamped out for every virtual client.
+	/// </summary>
+	/// <remarks>
+	/// The library takes ownership of the plugins and of the configuration of each client, so a new Configuration and new plugin instances are created per client.
+	/// What is shared is the immutable input: endpoint and application names, the plugin factories, and the settings with the objects they capture (logger, action dispatcher...).
+	/// install() registers an immutable snapshot of the template once as the default configurator of IClientFactory, instead of a configurator per client id.
+	/// </remarks>
+	class ConfigurationTemplate
+	{
+	public:
+		/// <summary>
+		/// Creates a template connecting to the test application.
+		/// </summary>
+		/// <param name="users">Adds the users plugin, required by Clients::login().</param>
+		explicit ConfigurationTemplate(bool users = true);
+
+		/// <summary>
+		/// Connects to another application of the test account.
+		/// </summary>
+		ConfigurationTemplate& application(const std::string& name);
+
+		/// <summary>
+		/// Connects through another API endpoint than the default one, such as a MetadataCache.
+		/// </summary>
+		ConfigurationTemplate& endpoint(const std::string& url);
+
+		/// <summary>
+		/// Sets the API endpoint of the templates created afterwards. Used to route all the clients of the process through a MetadataCache.
+		/// </summary>
+		static void setDefaultEndpoint(const std::string& url);
+
+		/// <summary>
+		/// API endpoint of the test server, http://localhost unless changed by setDefaultEndpoint().
+		/// </summary>
+		static std::string defaultEndpoint();
+
+		/// <summary>
+		/// API endpoint of the test server itself, ignoring setDefaultEndpoint(). Used by the tool's own MetadataCache instances, so that they don't go through each other.
+		/// </summary>
+		static std::string serverEndpoint();
+
+		template<typename TPlugin>
+		ConfigurationTemplate& addPlugin()
+		{
+			_plugins.push_back([]() -> Stormancer::IPlugin* { return new TPlugin(); });
+			return *this;
+		}
+
+		/// <summary>
+		/// Adds a setting applied to every configuration. Objects captured by the setting are shared by all the clients.
+		/// </summary>
+		ConfigurationTemplate& configure(std::function<void(Stormancer::Configuration&)> setting);
+
+		/// <summary>
+		/// Creates a configuration and plugin instances owned by a single client.
+		/// </summary>
+		std::shared_ptr<Stormancer::Configuration> create() const;
+
+		/// <summary>
+		/// Uses a snapshot of the template to create the configuration of each client created afterwards by IClientFactory without a specific configuration.
+		/// </summary>
+		void install() const;
+
+	private:
+		std::string _endpoint;
+		std::string _account;
+		std::string _application;
+		std::vector<std::function<Stormancer::IPlugin*()>> _plugins;
+		std::vector<std::function<void(Stormancer::Configuration&)>> _settings;
+	};
+}
@@ -0,0 +1,19 @@
+#include "CountingLogger.h"
+
+StressTool::CountingLogger::CountingLogger(std::string pattern, std::shared_ptr<std::atomic<std::uint64_t>> counter)
+	: _pattern(pattern)
+	, _counter(counter)
+{
+}
+
+void StressTool::CountingLogger::log(Stormancer::LogLevel, const std::string& category, const std::string& message, const std::string&)
+{
+	if (category.find(_pattern) != std::string::npos || message.find(_pattern) != std::string::npos)
+	{
+		(*_counter)++;
+	}
+}
+
+void StressTool::CountingLogger::log(const std::exception&)
+{
+}
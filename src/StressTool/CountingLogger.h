@@ -0,0 +1,27 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "stormancer/Logger/ILogger.h"
+
+namespace StressTool
+{
+	/// <summary>
+	/// Logger counting the messages that contain a pattern, used to count library events the client API doesn't expose.
+	/// </summary>
+	/// <remarks>
+	/// Messages are not written anywhere.
+	/// </remarks>
+	class CountingLogger : public Stormancer::ILogger
+	{
+	public:
+		CountingLogger(std::string pattern, std::shared_ptr<std::atomic<std::uint64_t>> counter);
+
+		void log(Stormancer::LogLevel level, const std::string& category, const std::string& message, const std::string& data = "") override;
+		void log(const std::exception& ex) override;
+
+	private:
+		std::string _pattern;
+		std::shared_ptr<std::atomic<std::uint64_t>> _counter;
+	};
+}
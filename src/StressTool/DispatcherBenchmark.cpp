@@ -0,0 +1,118 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "LockFreeActionDispatcher.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct DrainState
+	{
+		//Only written by the thread running update().
+		std::vector<StressTool::Result> latencies;
+	};
+
+	struct DispatchResult
+	{
+		double postsPerSecond;
+		StressTool::Stats latency;
+	};
+
+	template<typename TDispatcher>
+	DispatchResult measure(TDispatcher& dispatcher, int producers, int postsPerProducer, const std::string& metric)
+	{
+		auto total = static_cast<std::size_t>(producers) * postsPerProducer;
+		DrainState state;
+		state.latencies.reserve(total);
+
+		std::atomic<bool> go{ false };
+		std::atomic<int> ready{ 0 };
+		std::vector<Clock::time_point> finished(producers);
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++)
+		{
+			threads.emplace_back([&, p]() {
+				ready++;
+				while (!go)
+				{
+					std::this_thread::yield();
+				}
+				auto statePtr = &state;
+				for (int i = 0; i < postsPerProducer; i++)
+				{
+					auto postedOn = Clock::now();
+					dispatcher.post([statePtr, postedOn]() {
+						StressTool::Result r;
+						r.success = true;
+						r.duration = std::chrono::duration<double, std::milli>(Clock::now() - postedOn).count();
+						statePtr->latencies.push_back(r);
+					});
+				}
+				finished[p] = Clock::now();
+			});
+		}
+		while (ready < producers)
+		{
+			std::this_thread::yield();
+		}
+
+		auto start = Clock::now();
+		go = true;
+		//The calling thread pumps actions, as the main thread of a game would.
+		while (state.latencies.size() < total)
+		{
+			dispatcher.update(std::chrono::milliseconds(5));
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		DispatchResult result;
+		auto lastPost = *std::max_element(finished.begin(), finished.end());
+		result.postsPerSecond = total / std::chrono::duration<double>(lastPost - start).count();
+		result.latency = StressTool::stats(state.latencies);
+		StressTool::RunReport::record(metric, state.latencies);
+		StressTool::RunReport::setCounter(metric + ".postsPerSecond", result.postsPerSecond);
+		StressTool::addCompletedOperations(total);
+		return result;
+	}
+
+	void print(const char* name, int producers, const DispatchResult& r)
+	{
+		std::cout << std::setw(10) << name << std::setw(10) << producers << std::setw(14) << static_cast<std::uint64_t>(r.postsPerSecond)
+			<< std::setw(12) << r.latency.p50 << std::setw(12) << r.latency.p99 << std::setw(12) << r.latency.max << "\n";
+	}
+}
+
+int StressTool::runDispatcherBenchmark(const Options& options)
+{
+	auto posts = options.getInt("posts", 1000000);
+	auto maxProducers = options.getInt("maxProducers", 64);
+	auto capacity = options.getInt("capacity", 65536);
+	auto batchSize = options.getInt("drainBatch", 64);
+
+	std::cout << "action dispatcher, " << posts << " posts per run, latency from post to execution in ms\n";
+	std::cout << std::setw(10) << "queue" << std::setw(10) << "producers" << std::setw(14) << "posts/s"
+		<< std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << "\n";
+	for (int producers = 1; producers <= maxProducers; producers *= 2)
+	{
+		auto postsPerProducer = std::max(1, posts / producers);
+		{
+			Stormancer::MainThreadActionDispatcher dispatcher;
+			print("mutex", producers, measure(dispatcher, producers, postsPerProducer, "dispatcher.mutex." + std::to_string(producers)));
+		}
+		{
+			LockFreeActionDispatcher dispatcher(capacity, batchSize);
+			print("lockfree", producers, measure(dispatcher, producers, postsPerProducer, "dispatcher.lockfree." + std::to_string(producers)));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+#include "Echo.h"
+#include "Timer.h"
+#include <iostream>
+
+namespace
+{
+	pplx::task<void> echoLoop(std::shared_ptr<StressTool::EchoState> state)
+	{
+		if (state->remaining.fetch_sub(1) <= 0)
+		{
+			return pplx::task_from_result();
+		}
+
+		auto timer = std::make_shared<Timer>();
+		timer->start();
+		return state->rpc->rpc<std::string>("Test.TestSameSceneS2S", state->payload).then([state, timer](pplx::task<std::string> t) {
+			StressTool::Result r;
+			r.duration = timer->getElapsedTimeInMilliSec();
+			try
+			{
+				r.success = t.get().size() == state->payload.size();
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				r.success = false;
+			}
+			{
+				std::lock_guard<std::mutex> lg(state->resultsMutex);
+				state->results.push_back(r);
+			}
+			return echoLoop(state);
+		});
+	}
+}
+
+pplx::task<void> StressTool::runEcho(std::shared_ptr<EchoState> state, int window)
+{
+	std::vector<pplx::task<void>> loops;
+	for (int i = 0; i < window; i++)
+	{
+		loops.push_back(echoLoop(state));
+	}
+	return pplx::when_all(loops.begin(), loops.end());
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Stats.h"
+#include "stormancer/RPC/Service.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Messages echoed by a scene through Test.TestSameSceneS2S, and their results.
+	/// </summary>
+	struct EchoState
+	{
+		std::shared_ptr<Stormancer::RpcService> rpc;
+		std::string payload;
+		//Messages left to send, shared by the loops of the window.
+		std::atomic<int> remaining{ 0 };
+		std::mutex resultsMutex;
+		std::vector<Result> results;
+	};
+
+	/// <summary>
+	/// Sends the remaining messages of state, keeping window messages in flight.
+	/// </summary>
+	/// <remarks>
+	/// Each of the window loops sends its next message when the previous one completes. A failed or truncated echo is recorded as a failure and the loop continues.
+	/// </remarks>
+	/// <returns>A task that completes when all the messages completed.</returns>
+	pplx::task<void> runEcho(std::shared_ptr<EchoState> state, int window);
+}
@@ -0,0 +1,186 @@
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Echo.h"
+#include "Process.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	//Results of all the rounds of a variant.
+	struct VariantResults
+	{
+		std::vector<StressTool::Result> logins;
+		std::vector<StressTool::Result> rpcs;
+		//Time spent in the echo workload, and client CPU time during it, in seconds.
+		double rpcSeconds = 0;
+		double cpuSeconds = 0;
+	};
+
+	struct VariantStats
+	{
+		StressTool::Stats login;
+		StressTool::Stats rpc;
+		double rpcPerSecond = 0;
+		//Client CPU time per RPC, in microseconds.
+		double cpuPerRpc = 0;
+	};
+
+	VariantStats summarize(const VariantResults& results)
+	{
+		VariantStats s;
+		s.login = StressTool::stats(results.logins);
+		s.rpc = StressTool::stats(results.rpcs);
+		s.rpcPerSecond = results.rpcSeconds > 0 ? s.rpc.count / results.rpcSeconds : 0;
+		s.cpuPerRpc = s.rpc.count > 0 ? results.cpuSeconds * 1e6 / s.rpc.count : 0;
+		return s;
+	}
+
+	//Runs one round of a variant, adds its results to the variant and returns them.
+	VariantResults runVariant(bool encryption, int nbClients, int window, int messages, int payloadSize, VariantResults& total)
+	{
+		StressTool::ConfigurationTemplate()
+			.configure([encryption](Stormancer::Configuration& config) {
+				config.encryptionEnabled = encryption;
+			})
+			.install();
+
+		VariantResults round;
+		std::vector<pplx::task<StressTool::Result>> logins;
+		std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>> connections;
+		for (int i = 0; i < nbClients; i++)
+		{
+			auto timer = std::make_shared<Timer>();
+			timer->start();
+			auto login = StressTool::Clients::login(i);
+			logins.push_back(login.then([timer](pplx::task<std::shared_ptr<Stormancer::IClient>> t) {
+				StressTool::Result r;
+				r.duration = timer->getElapsedTimeInMilliSec();
+				try
+				{
+					t.get();
+					r.success = true;
+				}
+				catch (std::exception& ex)
+				{
+					std::cout << ex.what() << "\n";
+					r.success = false;
+				}
+				return r;
+			}));
+			connections.push_back(login.then([](std::shared_ptr<Stormancer::IClient> client) {
+				return client->connectToPublicScene("test-scene");
+			}));
+		}
+		round.logins = pplx::when_all(logins.begin(), logins.end()).get();
+
+		std::vector<std::shared_ptr<StressTool::EchoState>> states;
+		for (auto& scene : StressTool::Clients::waitConnections(connections))
+		{
+			if (scene)
+			{
+				auto state = std::make_shared<StressTool::EchoState>();
+				state->rpc = scene->dependencyResolver().resolve<Stormancer::RpcService>();
+				state->payload = std::string(payloadSize, 'x');
+				state->remaining = messages;
+				states.push_back(state);
+			}
+		}
+
+		if (!states.empty())
+		{
+			std::vector<pplx::task<void>> echoes;
+			auto cpuBefore = StressTool::Process::cpuTime();
+			Timer timer;
+			timer.start();
+			for (auto& state : states)
+			{
+				echoes.push_back(StressTool::runEcho(state, window));
+			}
+			pplx::when_all(echoes.begin(), echoes.end()).wait();
+			timer.stop();
+			round.cpuSeconds = StressTool::Process::cpuTime() - cpuBefore;
+			round.rpcSeconds = timer.getElapsedTimeInSec();
+			for (auto& state : states)
+			{
+				round.rpcs.insert(round.rpcs.end(), state->results.begin(), state->results.end());
+			}
+		}
+		else
+		{
+			std::cout << "no client connected to test-scene\n";
+		}
+
+		for (int i = 0; i < nbClients; i++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(i);
+		}
+
+		total.logins.insert(total.logins.end(), round.logins.begin(), round.logins.end());
+		total.rpcs.insert(total.rpcs.end(), round.rpcs.begin(), round.rpcs.end());
+		total.rpcSeconds += round.rpcSeconds;
+		total.cpuSeconds += round.cpuSeconds;
+		return round;
+	}
+
+	void print(const char* name, const VariantStats& s)
+	{
+		std::cout << std::setw(6) << name
+			<< std::setw(12) << s.login.p50 << std::setw(12) << s.login.p99
+			<< std::setw(10) << s.rpc.p50 << std::setw(10) << s.rpc.p99
+			<< std::setw(12) << s.rpcPerSecond << std::setw(12) << s.cpuPerRpc << "\n";
+	}
+
+	void report(const std::string& metric, const VariantResults& results, const VariantStats& s)
+	{
+		StressTool::RunReport::record(metric + "login", results.logins);
+		StressTool::RunReport::record(metric + "rpc", results.rpcs);
+		StressTool::RunReport::setCounter(metric + "rpcPerSecond", s.rpcPerSecond);
+		StressTool::RunReport::setCounter(metric + "cpuMicrosecondsPerRpc", s.cpuPerRpc);
+	}
+}
+
+int StressTool::runEncryptionBenchmark(const Options& options)
+{
+	auto nbClients = options.getInt("clients", 8);
+	auto window = options.getInt("window", 8);
+	auto messages = options.getInt("messages", 2000);
+	auto payloadSize = options.getInt("size", 256);
+	auto rounds = options.getInt("rounds", 2);
+
+	std::cout << "encryption overhead, " << nbClients << " clients, " << payloadSize << " B payloads\n";
+	std::cout << std::setw(6) << "crypt" << std::setw(12) << "login p50" << std::setw(12) << "login p99"
+		<< std::setw(10) << "rpc p50" << std::setw(10) << "rpc p99" << std::setw(12) << "rpc/s" << std::setw(12) << "cpu us/rpc" << "\n";
+
+	//Alternate both variants, so that slow drifts of the server or the network affect them equally.
+	VariantResults off;
+	VariantResults on;
+	for (int round = 0; round < rounds; round++)
+	{
+		print("off", summarize(runVariant(false, nbClients, window, messages, payloadSize, off)));
+		print("on", summarize(runVariant(true, nbClients, window, messages, payloadSize, on)));
+	}
+
+	//The differences are computed on the results of all the rounds.
+	auto offStats = summarize(off);
+	auto onStats = summarize(on);
+	report("encryption.off.", off, offStats);
+	report("encryption.on.", on, onStats);
+	addCompletedOperations(offStats.login.count + offStats.rpc.count + onStats.login.count + onStats.rpc.count);
+
+	std::cout << "all " << rounds << " rounds\n";
+	print("off", offStats);
+	print("on", onStats);
+	std::cout << "added login p50   : " << onStats.login.p50 - offStats.login.p50 << "ms\n";
+	std::cout << "added rpc p50     : " << onStats.rpc.p50 - offStats.rpc.p50 << "ms\n";
+	if (offStats.rpcPerSecond > 0)
+	{
+		std::cout << "throughput drop   : " << 100 * (1 - onStats.rpcPerSecond / offStats.rpcPerSecond) << "%\n";
+	}
+	std::cout << "added cpu per rpc : " << onStats.cpuPerRpc - offStats.cpuPerRpc << "us\n";
+	return 0;
+}
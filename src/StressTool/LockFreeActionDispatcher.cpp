@@ -0,0 +1,151 @@
+#include "LockFreeActionDispatcher.h"
+
+namespace
+{
+	std::size_t roundUpToPowerOfTwo(std::size_t value)
+	{
+		std::size_t result = 2;
+		while (result < value)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+}
+
+StressTool::LockFreeActionDispatcher::LockFreeActionDispatcher(std::size_t capacity, std::size_t batchSize)
+	: _mask(roundUpToPowerOfTwo(capacity) - 1)
+	, _batchSize(batchSize > 0 ? batchSize : 1)
+	, _cells(new Cell[_mask + 1])
+{
+	//Each cell holds the position it can be written at (sequence == position), or read at (sequence == position + 1).
+	for (std::size_t i = 0; i <= _mask; i++)
+	{
+		_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool StressTool::LockFreeActionDispatcher::tryPost(std::function<void(void)>& action)
+{
+	auto position = _enqueuePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		auto& cell = _cells[position & _mask];
+		auto sequence = cell.sequence.load(std::memory_order_acquire);
+		auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+		if (difference == 0)
+		{
+			if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.action = std::move(action);
+				cell.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			//The cell still holds the action posted one lap before: the queue is full.
+			return false;
+		}
+		else
+		{
+			position = _enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool StressTool::LockFreeActionDispatcher::tryTake(std::function<void(void)>& action)
+{
+	auto& cell = _cells[_dequeuePosition & _mask];
+	if (cell.sequence.load(std::memory_order_acquire) != _dequeuePosition + 1)
+	{
+		return false;
+	}
+	action = std::move(cell.action);
+	cell.action = nullptr;
+	//Frees the cell for the next lap.
+	cell.sequence.store(_dequeuePosition + _mask + 1, std::memory_order_release);
+	_dequeuePosition++;
+	return true;
+}
+
+void StressTool::LockFreeActionDispatcher::post(const std::function<void(void)> action)
+{
+	auto copy = action;
+	if (_consumer.load(std::memory_order_relaxed) == std::this_thread::get_id())
+	{
+		_consumerPosts.push_back(std::move(copy));
+		return;
+	}
+	if (!_overflowing.load(std::memory_order_acquire) && tryPost(copy))
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lg(_overflowMutex);
+	_overflow.push_back(std::move(copy));
+	_overflowing.store(true, std::memory_order_release);
+}
+
+void StressTool::LockFreeActionDispatcher::update(const std::chrono::milliseconds maxDuration)
+{
+	_consumer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+	auto end = std::chrono::steady_clock::now() + maxDuration;
+
+	//Actions posted by the previous update() run first.
+	std::vector<std::function<void(void)>> consumerPosts;
+	consumerPosts.swap(_consumerPosts);
+	for (auto& action : consumerPosts)
+	{
+		action();
+	}
+
+	std::function<void(void)> action;
+	while (true)
+	{
+		std::size_t count = 0;
+		while (count < _batchSize && tryTake(action))
+		{
+			action();
+			count++;
+		}
+		if (count < _batchSize || std::chrono::steady_clock::now() >= end)
+		{
+			break;
+		}
+	}
+
+	//The overflow list holds actions posted after those of the queue: it runs once every claimed cell has been consumed.
+	//A short batch isn't enough, as it also stops at a cell claimed by a producer that hasn't written its action yet.
+	//The check is done under the lock, so that a producer can't claim a cell and then add to this overflow list between the check and the swap.
+	if (_overflowing.load(std::memory_order_acquire))
+	{
+		std::vector<std::function<void(void)>> overflow;
+		{
+			std::lock_guard<std::mutex> lg(_overflowMutex);
+			if (_enqueuePosition.load(std::memory_order_relaxed) == _dequeuePosition)
+			{
+				overflow.swap(_overflow);
+				_overflowing.store(false, std::memory_order_release);
+			}
+		}
+		for (auto& overflowAction : overflow)
+		{
+			overflowAction();
+		}
+	}
+}
+
+void StressTool::LockFreeActionDispatcher::start()
+{
+	_running = true;
+}
+
+void StressTool::LockFreeActionDispatcher::stop()
+{
+	_running = false;
+}
+
+bool StressTool::LockFreeActionDispatcher::isRunning() const
+{
+	return _running;
+}
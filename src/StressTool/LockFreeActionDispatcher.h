@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+//Declares IActionDispatcher, the interface of the classes running stormancer callbacks & continuations.
+#include "stormancer/IActionDispatcher.h"
+
+namespace StressTool
+{
+	/// <summary>
+	/// Action dispatcher running callbacks on the thread calling update(), like MainThreadActionDispatcher, backed by a bounded lock-free queue.
+	/// </summary>
+	/// <remarks>
+	/// Network threads post without taking a lock: posting is a compare and swap on the enqueue position, and the consumer drains actions in batches,
+	/// reading the clock once per batch.
+	/// When the queue is full, actions go to an overflow list guarded by a mutex until update() drains it, so that network threads never wait for a slow update() caller.
+	/// While the overflow list isn't empty, all producers post to it: the actions of a producer run in the order it posted them.
+	/// Unlike MainThreadActionDispatcher, actions posted by the thread running update() don't run in that update(): they run first in the next one,
+	/// before actions posted earlier by other threads. This adds up to one update period of latency to continuations chained on the update thread.
+	/// </remarks>
+	class LockFreeActionDispatcher : public Stormancer::IActionDispatcher
+	{
+	public:
+		/// <param name="capacity">Number of actions the queue holds, rounded up to a power of two.</param>
+		/// <param name="batchSize">Number of actions run between two checks of update() maxDuration.</param>
+		explicit LockFreeActionDispatcher(std::size_t capacity = 65536, std::size_t batchSize = 64);
+
+		/// <summary>
+		/// Runs queued actions on the calling thread for at most maxDuration, or until the queue is empty.
+		/// </summary>
+		void update(const std::chrono::milliseconds maxDuration);
+
+		void post(const std::function<void(void)> action) override;
+		void start() override;
+		void stop() override;
+		bool isRunning() const override;
+
+	private:
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;
+			std::function<void(void)> action;
+		};
+
+		bool tryPost(std::function<void(void)>& action);
+		bool tryTake(std::function<void(void)>& action);
+
+		const std::size_t _mask;
+		const std::size_t _batchSize;
+		std::unique_ptr<Cell[]> _cells;
+		//Producers and the consumer update different positions: keep them on different cache lines.
+		alignas(64) std::atomic<std::size_t> _enqueuePosition{ 0 };
+		alignas(64) std::size_t _dequeuePosition = 0;
+		std::vector<std::function<void(void)>> _consumerPosts;
+		std::mutex _overflowMutex;
+		std::vector<std::function<void(void)>> _overflow;
+		std::atomic<bool> _overflowing{ false };
+		std::atomic<std::thread::id> _consumer{ std::thread::id() };
+		std::atomic<bool> _running{ true };
+	};
+}
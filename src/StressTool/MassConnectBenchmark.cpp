@@ -0,0 +1,106 @@
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "MetadataCache.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+	struct ConnectResult
+	{
+		std::vector<StressTool::Result> logins;
+		double elapsed;
+	};
+
+	//Logs in all the clients at once, and returns when the last one is connected or failed.
+	ConnectResult connectAll(int clients)
+	{
+		std::vector<pplx::task<StressTool::Result>> tasks;
+		Timer timer;
+		timer.start();
+		for (int id = 0; id < clients; id++)
+		{
+			auto clientTimer = std::make_shared<Timer>();
+			clientTimer->start();
+			tasks.push_back(StressTool::Clients::login(id).then([clientTimer](pplx::task<std::shared_ptr<Stormancer::IClient>> t) {
+				StressTool::Result r;
+				r.duration = clientTimer->getElapsedTimeInMilliSec();
+				try
+				{
+					t.get();
+					r.success = true;
+				}
+				catch (std::exception& ex)
+				{
+					std::cout << ex.what() << "\n";
+					r.success = false;
+				}
+				return r;
+			}));
+		}
+		ConnectResult result;
+		result.logins = pplx::when_all(tasks.begin(), tasks.end()).get();
+		result.elapsed = timer.getElapsedTimeInSec();
+
+		for (int id = 0; id < clients; id++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(id);
+		}
+		return result;
+	}
+}
+
+int StressTool::runMassConnectBenchmark(const Options& options)
+{
+	auto clients = options.getInt("clients", 1000);
+	auto rounds = options.getInt("rounds", 2);
+	auto ttl = options.getDouble("metadataCacheTtl", 30);
+	//The direct rounds must not go through the process wide cache enabled by --metadataCache.
+	auto server = ConfigurationTemplate::serverEndpoint();
+
+	std::cout << "mass connect: " << clients << " clients logging in at once, without and with a shared metadata cache (TTL " << ttl << "s)\n";
+	std::cout << std::setw(8) << "round" << std::setw(10) << "cache" << std::setw(10) << "total(s)" << std::setw(12) << "clients/s"
+		<< std::setw(10) << "p50(ms)" << std::setw(10) << "p99(ms)" << std::setw(10) << "success" << std::setw(16) << "HTTP requests" << "\n";
+
+	for (int round = 0; round < rounds; round++)
+	{
+		for (auto cached : { false, true })
+		{
+			//A new cache each round, so that the first requests miss like in a new process.
+			std::unique_ptr<MetadataCache> cache;
+			if (cached)
+			{
+				cache.reset(new MetadataCache(server, ttl));
+				if (!cache->start())
+				{
+					std::cout << "metadata cache: " << cache->error() << "\n";
+					return 2;
+				}
+			}
+			ConfigurationTemplate().endpoint(cached ? cache->endpoint() : server).install();
+
+			auto result = connectAll(clients);
+			auto s = stats(result.logins);
+			addCompletedOperations(s.count);
+			auto name = std::string("massconnect.") + (cached ? "cached" : "direct");
+			RunReport::record(name, result.logins);
+			RunReport::setCounter(name + ".round" + std::to_string(round) + ".elapsed", result.elapsed);
+
+			std::cout << std::setw(8) << round << std::setw(10) << (cached ? "on" : "off") << std::setw(10) << result.elapsed << std::setw(12) << s.count / result.elapsed
+				<< std::setw(10) << s.p50 << std::setw(10) << s.p99 << std::setw(9) << s.successRate * 100 << "%";
+			if (cached)
+			{
+				auto& counters = cache->counters();
+				//Requests the clients sent, and in parentheses the requests that reached the server.
+				std::cout << std::setw(8) << counters.hits + counters.misses + counters.forwarded << " (" << counters.misses + counters.forwarded << ")";
+			}
+			std::cout << "\n";
+		}
+	}
+	return 0;
+}
@@ -1,12 +1,12 @@
 #include "Worker.h"
 #include "Timer.h"
+#include "ConfigurationTemplate.h"
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
 #include "stormancer/Logger/VisualStudioLogger.h"
 //Provides APIs related to authentication & user management.
 #include "Users/Users.hpp"
 
-constexpr const char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr const char* Account = "tests";
 constexpr const char* Application = "test";
 
@@ -17,7 +17,7 @@ pplx::task<StressTool::Result> StressTool::MessagesWorker::run(int id)
 	Stormancer::IClientFactory::SetConfig(id, [](size_t) {
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(StressTool::ConfigurationTemplate::defaultEndpoint(), std::string(Account), std::string(Application));
 		//config->logger = std::make_shared<Stormancer::VisualStudioLogger>();
 		//Add plugins required by the test.
 		config->addPlugin(new Stormancer::Users::UsersPlugin());
@@ -0,0 +1,474 @@
+#define NOMINMAX
+#include "MetadataCache.h"
+#include "Sockets.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using namespace StressTool::Sockets;
+	using Clock = std::chrono::steady_clock;
+
+	const int PollTimeoutMs = 100;
+	//Connections that don't send or receive anything for this long are closed.
+	const int IoTimeoutMs = 10000;
+	const std::size_t MaxHeadSize = 64 * 1024;
+	const std::size_t MaxBodySize = 16 * 1024 * 1024;
+	//Request headers a response can vary on. They are part of the cache key, so that clients asking for different representations don't share them.
+	const char* const KeyHeaders[] = { "accept", "accept-charset", "accept-encoding", "accept-language" };
+
+	struct Request
+	{
+		std::string method;
+		std::string target;
+		std::vector<std::pair<std::string, std::string>> headers;
+		std::vector<char> body;
+
+		bool hasHeader(const std::string& name) const
+		{
+			return std::any_of(headers.begin(), headers.end(), [&name](const std::pair<std::string, std::string>& header) { return header.first == name; });
+		}
+	};
+
+	std::string lower(std::string value)
+	{
+		std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return value;
+	}
+
+	std::string trim(const std::string& value)
+	{
+		auto begin = value.find_first_not_of(" \t");
+		auto end = value.find_last_not_of(" \t\r");
+		return begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+	}
+
+	//Returns the number of bytes received, 0 when the connection is closed, and -1 on error or timeout.
+	int receive(Socket s, char* buffer, std::size_t size)
+	{
+		pollfd fd = { s, POLLIN, 0 };
+		if (pollSockets(&fd, 1, IoTimeoutMs) <= 0)
+		{
+			return -1;
+		}
+		return recv(s, buffer, static_cast<int>(size), 0);
+	}
+
+	bool readRequest(Socket s, Request& request)
+	{
+		std::vector<char> data;
+		char buffer[4096];
+		std::size_t headEnd = std::string::npos;
+		while (headEnd == std::string::npos)
+		{
+			auto n = receive(s, buffer, sizeof(buffer));
+			if (n <= 0 || data.size() > MaxHeadSize)
+			{
+				return false;
+			}
+			data.insert(data.end(), buffer, buffer + n);
+			auto found = std::search(data.begin(), data.end(), "\r\n\r\n", "\r\n\r\n" + 4);
+			if (found != data.end())
+			{
+				headEnd = found - data.begin();
+			}
+		}
+
+		std::istringstream head(std::string(data.begin(), data.begin() + headEnd));
+		std::string line;
+		std::getline(head, line);
+		std::istringstream requestLine(line);
+		requestLine >> request.method >> request.target;
+		std::size_t contentLength = 0;
+		while (std::getline(head, line))
+		{
+			auto colon = line.find(':');
+			if (colon == std::string::npos)
+			{
+				continue;
+			}
+			auto name = lower(trim(line.substr(0, colon)));
+			auto value = trim(line.substr(colon + 1));
+			if (name == "content-length")
+			{
+				//Malformed or oversized bodies end the connection without an answer.
+				if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+				{
+					return false;
+				}
+				try
+				{
+					contentLength = std::stoul(value);
+				}
+				catch (std::out_of_range&)
+				{
+					return false;
+				}
+				if (contentLength > MaxBodySize)
+				{
+					return false;
+				}
+			}
+			request.headers.emplace_back(name, value);
+		}
+
+		request.body.assign(data.begin() + headEnd + 4, data.end());
+		while (request.body.size() < contentLength)
+		{
+			auto n = receive(s, buffer, sizeof(buffer));
+			if (n <= 0)
+			{
+				return false;
+			}
+			request.body.insert(request.body.end(), buffer, buffer + n);
+		}
+		return !request.method.empty();
+	}
+
+	//Rewrites the request for the server: its Host, and a connection closed after the response, so that the response ends when the connection closes.
+	std::vector<char> upstreamRequest(const Request& request, const std::string& host)
+	{
+		std::string head = request.method + " " + request.target + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n";
+		for (auto& header : request.headers)
+		{
+			if (header.first != "host" && header.first != "connection" && header.first != "keep-alive")
+			{
+				head += header.first + ": " + header.second + "\r\n";
+			}
+		}
+		head += "\r\n";
+		std::vector<char> data(head.begin(), head.end());
+		data.insert(data.end(), request.body.begin(), request.body.end());
+		return data;
+	}
+
+	std::string cacheKey(const Request& request)
+	{
+		auto key = request.target;
+		for (auto name : KeyHeaders)
+		{
+			key += '\n';
+			for (auto& header : request.headers)
+			{
+				if (header.first == name)
+				{
+					key += header.second + ",";
+				}
+			}
+		}
+		return key;
+	}
+
+	//Successful responses are cached, unless they vary on request headers that aren't part of the cache key.
+	bool cacheable(const std::vector<char>& response)
+	{
+		auto headEnd = std::search(response.begin(), response.end(), "\r\n\r\n", "\r\n\r\n" + 4);
+		std::istringstream head(std::string(response.begin(), headEnd));
+		std::string line;
+		std::getline(head, line);
+		std::istringstream statusLine(line);
+		std::string version;
+		int status = 0;
+		statusLine >> version >> status;
+		if (status != 200)
+		{
+			return false;
+		}
+		while (std::getline(head, line))
+		{
+			auto colon = line.find(':');
+			if (colon == std::string::npos || lower(trim(line.substr(0, colon))) != "vary")
+			{
+				continue;
+			}
+			std::istringstream names(line.substr(colon + 1));
+			std::string name;
+			while (std::getline(names, name, ','))
+			{
+				name = lower(trim(name));
+				if (!name.empty() && std::none_of(std::begin(KeyHeaders), std::end(KeyHeaders), [&name](const char* key) { return name == key; }))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+struct StressTool::MetadataCache::Impl
+{
+	struct Entry
+	{
+		bool fetching = false;
+		std::vector<char> response;
+		Clock::time_point expires;
+	};
+
+#if defined(WIN32) || defined(_WIN32)
+	WinsockInit winsock;
+#endif
+	std::string targetHost;
+	int targetPort = 80;
+	Clock::duration ttl;
+	int workerCount = 0;
+	std::string error;
+	Counters counters;
+	int listenPort = 0;
+	Socket listenSocket = InvalidSocket;
+	std::atomic<bool> stopping{ false };
+	std::thread acceptThread;
+	std::vector<std::thread> workers;
+
+	//Accepted connections waiting for a worker.
+	std::mutex queueMutex;
+	std::condition_variable queued;
+	std::deque<Socket> pending;
+
+	std::mutex mutex;
+	std::condition_variable fetched;
+	std::map<std::string, Entry> entries;
+
+	void acceptLoop()
+	{
+		while (!stopping)
+		{
+			pollfd fd = { listenSocket, POLLIN, 0 };
+			if (pollSockets(&fd, 1, PollTimeoutMs) > 0 && (fd.revents & POLLIN))
+			{
+				auto client = accept(listenSocket, nullptr, nullptr);
+				if (client != InvalidSocket)
+				{
+					std::lock_guard<std::mutex> lg(queueMutex);
+					pending.push_back(client);
+					queued.notify_one();
+				}
+			}
+		}
+	}
+
+	void workerLoop()
+	{
+		while (true)
+		{
+			Socket client;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queued.wait(lock, [this]() { return stopping || !pending.empty(); });
+				if (stopping)
+				{
+					return;
+				}
+				client = pending.front();
+				pending.pop_front();
+			}
+			handle(client);
+			closeSocket(client);
+		}
+	}
+
+	void handle(Socket client)
+	{
+		Request request;
+		if (!readRequest(client, request))
+		{
+			return;
+		}
+		auto upstream = upstreamRequest(request, targetPort == 80 ? targetHost : targetHost + ":" + std::to_string(targetPort));
+
+		if (request.method != "GET" || request.hasHeader("authorization"))
+		{
+			counters.forwarded++;
+			sendAll(client, fetch(upstream));
+			return;
+		}
+
+		auto key = cacheKey(request);
+		std::unique_lock<std::mutex> lock(mutex);
+		bool waited = false;
+		while (true)
+		{
+			auto& entry = entries[key];
+			if (!entry.response.empty() && Clock::now() < entry.expires)
+			{
+				auto response = entry.response;
+				lock.unlock();
+				counters.hits++;
+				sendAll(client, response);
+				return;
+			}
+			if (!entry.fetching || waited)
+			{
+				break;
+			}
+			//Single flight: wait for the request already sent, then use its response, or send the request if it failed.
+			counters.coalesced++;
+			waited = true;
+			fetched.wait_for(lock, std::chrono::milliseconds(IoTimeoutMs), [&entry]() { return !entry.fetching; });
+		}
+		entries[key].fetching = true;
+		lock.unlock();
+
+		counters.misses++;
+		auto response = fetch(upstream);
+
+		lock.lock();
+		auto& entry = entries[key];
+		entry.fetching = false;
+		if (cacheable(response))
+		{
+			entry.response = response;
+			entry.expires = Clock::now() + ttl;
+		}
+		lock.unlock();
+		fetched.notify_all();
+		sendAll(client, response);
+	}
+
+	//Sends the request to the server and returns its response, read until the server closes the connection.
+	std::vector<char> fetch(const std::vector<char>& request)
+	{
+		std::vector<char> response;
+		sockaddr_in address;
+		if (!resolve(targetHost, targetPort, address))
+		{
+			return response;
+		}
+		auto server = socket(AF_INET, SOCK_STREAM, 0);
+		if (server == InvalidSocket)
+		{
+			return response;
+		}
+		if (connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && sendAll(server, request))
+		{
+			char buffer[16384];
+			int n;
+			while ((n = receive(server, buffer, sizeof(buffer))) > 0)
+			{
+				response.insert(response.end(), buffer, buffer + n);
+			}
+		}
+		closeSocket(server);
+		return response;
+	}
+};
+
+StressTool::MetadataCache::MetadataCache(const std::string& target, double ttl, int workers)
+	: _impl(new Impl())
+{
+	_impl->ttl = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(ttl));
+	_impl->workerCount = std::max(workers, 1);
+
+	//http://host[:port][/]
+	auto scheme = target.find("://");
+	if (scheme != std::string::npos && lower(target.substr(0, scheme)) != "http")
+	{
+		_impl->error = "only http targets are supported: " + target;
+		return;
+	}
+	auto host = target.substr(scheme == std::string::npos ? 0 : scheme + 3);
+	host = host.substr(0, host.find('/'));
+	auto colon = host.find(':');
+	if (colon != std::string::npos)
+	{
+		try
+		{
+			_impl->targetPort = std::stoi(host.substr(colon + 1));
+		}
+		catch (std::exception&)
+		{
+			_impl->error = "invalid port in " + target;
+			return;
+		}
+		host = host.substr(0, colon);
+	}
+	_impl->targetHost = host;
+}
+
+StressTool::MetadataCache::~MetadataCache()
+{
+	stop();
+}
+
+bool StressTool::MetadataCache::start(int listenPort)
+{
+	if (!_impl->error.empty())
+	{
+		return false;
+	}
+	//The cache forwards requests to the server for anyone who can connect: only local clients can.
+	_impl->listenSocket = bindSocket(SOCK_STREAM, listenPort, true);
+	if (_impl->listenSocket == InvalidSocket)
+	{
+		_impl->error = "can't listen on TCP port " + std::to_string(listenPort);
+		return false;
+	}
+	sockaddr_in address;
+	socklen_t length = sizeof(address);
+	getsockname(_impl->listenSocket, reinterpret_cast<sockaddr*>(&address), &length);
+	_impl->listenPort = ntohs(address.sin_port);
+
+	auto impl = _impl.get();
+	for (int i = 0; i < _impl->workerCount; i++)
+	{
+		_impl->workers.emplace_back([impl]() { impl->workerLoop(); });
+	}
+	_impl->acceptThread = std::thread([impl]() { impl->acceptLoop(); });
+	return true;
+}
+
+void StressTool::MetadataCache::stop()
+{
+	if (_impl->stopping.exchange(true))
+	{
+		return;
+	}
+	if (_impl->acceptThread.joinable())
+	{
+		_impl->acceptThread.join();
+	}
+	{
+		//Taking the lock orders the change of stopping with the workers checking it before they wait.
+		std::lock_guard<std::mutex> lg(_impl->queueMutex);
+	}
+	_impl->queued.notify_all();
+	//Workers end their current request, after at most IoTimeoutMs without traffic.
+	for (auto& worker : _impl->workers)
+	{
+		worker.join();
+	}
+	for (auto client : _impl->pending)
+	{
+		closeSocket(client);
+	}
+	_impl->pending.clear();
+	if (_impl->listenSocket != InvalidSocket)
+	{
+		closeSocket(_impl->listenSocket);
+	}
+}
+
+std::string StressTool::MetadataCache::endpoint() const
+{
+	return "http://127.0.0.1:" + std::to_string(_impl->listenPort);
+}
+
+const std::string& StressTool::MetadataCache::error() const
+{
+	return _impl->error;
+}
+
+const StressTool::MetadataCache::Counters& StressTool::MetadataCache::counters() const
+{
+	return _impl->counters;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Local HTTP proxy to the server API, shared by all the clients of the process, that caches the responses to metadata requests.
+	/// </summary>
+	/// <remarks>
+	/// Clients discover the endpoints and the federation of the server over HTTP before connecting. These responses are the same for every client:
+	/// through the cache, they are requested once per TTL instead of once per client.
+	/// Successful GET requests without Authorization header are cached for the TTL. Concurrent misses on the same request wait for a single upstream request.
+	/// Requests are cached by target and Accept, Accept-Charset, Accept-Encoding and Accept-Language headers; responses varying on other headers aren't cached.
+	/// Other requests, such as scene token requests, are forwarded.
+	/// The cache listens on 127.0.0.1 only, forwards to http targets only, and serves connections from a fixed pool of worker threads.
+	/// </remarks>
+	class MetadataCache
+	{
+	public:
+		/// <param name="target">Server API endpoint, such as http://localhost.</param>
+		/// <param name="ttl">Time during which a response is served from the cache, in seconds.</param>
+		/// <param name="workers">Connections served concurrently. Each waits for the server on a miss or a forwarded request.</param>
+		MetadataCache(const std::string& target, double ttl, int workers = 64);
+		~MetadataCache();
+
+		MetadataCache(const MetadataCache&) = delete;
+		MetadataCache& operator=(const MetadataCache&) = delete;
+
+		/// <summary>
+		/// Listens on listenPort of the loopback interface, or on a port chosen by the system if listenPort is 0.
+		/// </summary>
+		/// <returns>false if the target isn't a valid http endpoint or the port can't be bound, see error().</returns>
+		bool start(int listenPort = 0);
+
+		void stop();
+
+		/// <summary>
+		/// Endpoint to give to the clients instead of the target, such as http://127.0.0.1:54321.
+		/// </summary>
+		std::string endpoint() const;
+
+		const std::string& error() const;
+
+		struct Counters
+		{
+			std::atomic<std::uint64_t> hits{ 0 };
+			//Cacheable requests sent to the server.
+			std::atomic<std::uint64_t> misses{ 0 };
+			//Misses that waited for the same request already sent by another client.
+			std::atomic<std::uint64_t> coalesced{ 0 };
+			//Requests that can't be cached, sent to the server.
+			std::atomic<std::uint64_t> forwarded{ 0 };
+		};
+
+		const Counters& counters() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+}
@@ -0,0 +1,732 @@
+#define NOMINMAX
+#include "NetworkProxy.h"
+#include "Sockets.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+
+
+namespace
+{
+	using namespace StressTool::Sockets;
+
+	using Clock = std::chrono::steady_clock;
+
+	//UDP datagrams are dropped when a client's bandwidth queue is longer than this, like in a router buffer.
+	const auto MaxQueueDelay = std::chrono::milliseconds(500);
+	//UDP flows without traffic for this long are closed.
+	const auto UdpIdleTimeout = std::chrono::seconds(60);
+	//A TCP flow stops reading from one side while this much of its data is delayed or waiting to be written to the other side.
+	const std::size_t MaxTcpBuffered = 1024 * 1024;
+	const int PollTimeoutMs = 100;
+
+	/// <summary>
+	/// Runs actions at their scheduled time on a dedicated thread. Actions scheduled for the same time run in scheduling order.
+	/// </summary>
+	/// <remarks>
+	/// Actions must not block: the line is shared by all the flows of a protocol.
+	/// </remarks>
+	class DelayLine
+	{
+	public:
+		DelayLine()
+			: _thread([this]() { run(); })
+		{
+		}
+
+		//Drops the actions not run yet: data still delayed when the proxy stops is lost, as in a network going down.
+		~DelayLine()
+		{
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_stopping = true;
+			}
+			_condition.notify_one();
+			_thread.join();
+		}
+
+		void schedule(Clock::time_point at, std::function<void()> action)
+		{
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_items.push(Item{ at, _nextSequence++, std::move(action) });
+			}
+			_condition.notify_one();
+		}
+
+	private:
+		struct Item
+		{
+			Clock::time_point at;
+			std::uint64_t sequence;
+			std::function<void()> action;
+
+			bool operator>(const Item& other) const
+			{
+				return at != other.at ? at > other.at : sequence > other.sequence;
+			}
+		};
+
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (!_stopping)
+			{
+				if (_items.empty())
+				{
+					_condition.wait(lock);
+				}
+				else if (_items.top().at <= Clock::now())
+				{
+					auto action = _items.top().action;
+					_items.pop();
+					lock.unlock();
+					action();
+					lock.lock();
+				}
+				else
+				{
+					_condition.wait_until(lock, _items.top().at);
+				}
+			}
+		}
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::priority_queue<Item, std::vector<Item>, std::greater<Item>> _items;
+		std::uint64_t _nextSequence = 0;
+		bool _stopping = false;
+		//Last member: started once the others are initialized.
+		std::thread _thread;
+	};
+
+	/// <summary>
+	/// State of one direction of a flow.
+	/// </summary>
+	struct Direction
+	{
+		double baseLatency = 0;
+		Clock::time_point lastDelivery;
+		//When the bandwidth cap lets the next bytes go.
+		Clock::time_point linkFree;
+	};
+
+	Clock::duration milliseconds(double ms)
+	{
+		return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+	}
+
+	double drawBaseLatency(const StressTool::Impairment& impairment, std::mt19937& random)
+	{
+		std::uniform_real_distribution<double> spread(1 - impairment.latencySpread, 1 + impairment.latencySpread);
+		return impairment.latency * spread(random);
+	}
+
+	/// <summary>
+	/// Computes when a packet sent now in a direction is delivered.
+	/// </summary>
+	/// <returns>false if the packet is dropped.</returns>
+	bool deliveryTime(const StressTool::Impairment& impairment, Direction& direction, std::size_t bytes, bool datagram, std::mt19937& random, StressTool::NetworkProxy::Counters& counters, Clock::time_point& result)
+	{
+		std::uniform_real_distribution<double> uniform(0, 1);
+		if (datagram && impairment.loss > 0 && uniform(random) < impairment.loss)
+		{
+			counters.dropped++;
+			return false;
+		}
+
+		auto now = Clock::now();
+		auto sent = now;
+		if (impairment.bandwidth > 0)
+		{
+			sent = std::max(now, direction.linkFree);
+			if (datagram && sent - now > MaxQueueDelay)
+			{
+				counters.dropped++;
+				return false;
+			}
+			direction.linkFree = sent + milliseconds(bytes * 8 / impairment.bandwidth);
+			sent = direction.linkFree;
+		}
+
+		auto latency = direction.baseLatency;
+		if (impairment.jitter > 0)
+		{
+			std::normal_distribution<double> jitter(0, impairment.jitter);
+			latency = std::max(0.0, latency + jitter(random));
+		}
+		result = sent + milliseconds(latency);
+
+		if (datagram && impairment.reorder > 0 && uniform(random) < impairment.reorder)
+		{
+			//Held back, so that the next datagrams overtake it. The flow order isn't updated.
+			counters.reordered++;
+			result += milliseconds(std::max(1.0, direction.baseLatency / 2 + 2 * impairment.jitter));
+			return true;
+		}
+
+		//Jitter alone doesn't reorder packets: a packet isn't delivered before the previous packet of its flow.
+		result = std::max(result, direction.lastDelivery);
+		direction.lastDelivery = result;
+		return true;
+	}
+
+	struct UdpFlow
+	{
+		Socket upstream = InvalidSocket;
+		sockaddr_in client;
+		Direction toServer;
+		Direction toClient;
+		Clock::time_point lastActivity;
+
+		~UdpFlow()
+		{
+			if (upstream != InvalidSocket)
+			{
+				closeSocket(upstream);
+			}
+		}
+	};
+
+	/// <summary>
+	/// One direction of a TCP flow: data read from a socket, delayed, then written to the other.
+	/// </summary>
+	struct TcpHalf
+	{
+		Socket from = InvalidSocket;
+		Socket to = InvalidSocket;
+		Direction direction;
+		//Bytes read and not written yet, delayed or in outgoing.
+		std::size_t buffered = 0;
+		//Data due, not accepted yet by the socket buffer of to.
+		std::vector<char> outgoing;
+		//from reached the end of its stream.
+		bool readClosed = false;
+		//The end of the stream is due: to is shut down once outgoing is written.
+		bool endDue = false;
+		//to is shut down for writing.
+		bool done = false;
+	};
+
+	/// <summary>
+	/// A TCP connection through the proxy. The poll loop reads, the delay line writes: the halves are guarded by the mutex.
+	/// </summary>
+	struct TcpFlow
+	{
+		Socket client = InvalidSocket;
+		Socket server = InvalidSocket;
+		//The connection to the server is in progress: only the poll loop uses the flow until it completes.
+		bool connecting = false;
+		std::mutex mutex;
+		TcpHalf toServer;
+		TcpHalf toClient;
+
+		//Delayed data holds the flow until it is written, the sockets are closed with the last of it.
+		~TcpFlow()
+		{
+			closeSocket(client);
+			closeSocket(server);
+		}
+	};
+
+	short pollEvents(const TcpHalf& reading, const TcpHalf& writing)
+	{
+		short events = 0;
+		if (!reading.readClosed && reading.buffered < MaxTcpBuffered)
+		{
+			events |= POLLIN;
+		}
+		if (!writing.done && !writing.outgoing.empty())
+		{
+			events |= POLLOUT;
+		}
+		return events;
+	}
+}
+
+struct StressTool::NetworkProxy::Impl
+{
+#if defined(WIN32) || defined(_WIN32)
+	WinsockInit winsock;
+#endif
+	Impairment impairment;
+	std::string targetHost;
+	std::string error;
+	Counters counters;
+	std::atomic<bool> stopping{ false };
+	std::vector<std::thread> threads;
+
+	Socket udpListen = InvalidSocket;
+	sockaddr_in udpTarget;
+	std::unique_ptr<DelayLine> udpLine{ new DelayLine() };
+
+	Socket tcpListen = InvalidSocket;
+	sockaddr_in tcpTarget;
+	std::unique_ptr<DelayLine> tcpLine{ new DelayLine() };
+
+	void udpLoop()
+	{
+		std::mt19937 random(std::random_device{}());
+		std::map<std::string, std::shared_ptr<UdpFlow>> flows;
+		std::vector<pollfd> fds;
+		std::vector<std::shared_ptr<UdpFlow>> polled;
+		std::vector<char> buffer(65536);
+
+		while (!stopping)
+		{
+			fds.clear();
+			polled.clear();
+			pollfd listenFd = { udpListen, POLLIN, 0 };
+			fds.push_back(listenFd);
+			for (auto& flow : flows)
+			{
+				pollfd fd = { flow.second->upstream, POLLIN, 0 };
+				fds.push_back(fd);
+				polled.push_back(flow.second);
+			}
+			if (pollSockets(fds.data(), fds.size(), PollTimeoutMs) <= 0)
+			{
+				continue;
+			}
+			auto now = Clock::now();
+
+			if (fds[0].revents & POLLIN)
+			{
+				sockaddr_in from;
+				socklen_t fromLength = sizeof(from);
+				auto n = recvfrom(udpListen, buffer.data(), static_cast<int>(buffer.size()), 0, reinterpret_cast<sockaddr*>(&from), &fromLength);
+				if (n > 0)
+				{
+					std::string key(reinterpret_cast<const char*>(&from.sin_addr), sizeof(from.sin_addr));
+					key.append(reinterpret_cast<const char*>(&from.sin_port), sizeof(from.sin_port));
+					auto it = flows.find(key);
+					auto flow = it != flows.end() ? it->second : startUdpFlow(from, random);
+					if (!flow)
+					{
+						//No socket to the server: the datagram is lost, and the next one from the client tries again.
+						counters.dropped++;
+					}
+					else
+					{
+						if (it == flows.end())
+						{
+							flows[key] = flow;
+							counters.flows++;
+						}
+						flow->lastActivity = now;
+						forward(flow, flow->toServer, std::vector<char>(buffer.begin(), buffer.begin() + n), true, random);
+					}
+				}
+			}
+
+			for (std::size_t i = 1; i < fds.size(); i++)
+			{
+				if (fds[i].revents & POLLIN)
+				{
+					auto& flow = polled[i - 1];
+					auto n = recv(flow->upstream, buffer.data(), static_cast<int>(buffer.size()), 0);
+					if (n > 0)
+					{
+						flow->lastActivity = now;
+						forward(flow, flow->toClient, std::vector<char>(buffer.begin(), buffer.begin() + n), false, random);
+					}
+				}
+			}
+
+			for (auto it = flows.begin(); it != flows.end();)
+			{
+				if (now - it->second->lastActivity > UdpIdleTimeout)
+				{
+					counters.flows--;
+					//Datagrams still delayed keep the flow alive until delivered.
+					it = flows.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+		counters.flows -= static_cast<int>(flows.size());
+	}
+
+	std::shared_ptr<UdpFlow> startUdpFlow(const sockaddr_in& client, std::mt19937& random)
+	{
+		auto flow = std::make_shared<UdpFlow>();
+		flow->client = client;
+		flow->upstream = socket(AF_INET, SOCK_DGRAM, 0);
+		if (flow->upstream == InvalidSocket || connect(flow->upstream, reinterpret_cast<sockaddr*>(&udpTarget), sizeof(udpTarget)) != 0)
+		{
+			return nullptr;
+		}
+		flow->toServer.baseLatency = drawBaseLatency(impairment, random);
+		flow->toClient.baseLatency = flow->toServer.baseLatency;
+		return flow;
+	}
+
+	void forward(std::shared_ptr<UdpFlow> flow, Direction& direction, std::vector<char> data, bool toServer, std::mt19937& random)
+	{
+		Clock::time_point at;
+		if (!deliveryTime(impairment, direction, data.size(), true, random, counters, at))
+		{
+			return;
+		}
+		auto listen = udpListen;
+		udpLine->schedule(at, [this, flow, data, toServer, listen]() {
+			if (toServer)
+			{
+				send(flow->upstream, data.data(), static_cast<int>(data.size()), 0);
+			}
+			else
+			{
+				sendto(listen, data.data(), static_cast<int>(data.size()), 0, reinterpret_cast<const sockaddr*>(&flow->client), sizeof(flow->client));
+			}
+			counters.forwarded++;
+			counters.bytes += data.size();
+		});
+	}
+
+	//A single thread polls the listening socket and every TCP flow: the cost of a connection is two sockets, not threads.
+	void tcpLoop()
+	{
+		std::mt19937 random(std::random_device{}());
+		std::vector<std::shared_ptr<TcpFlow>> flows;
+		std::vector<pollfd> fds;
+		std::vector<char> buffer(16384);
+
+		while (!stopping)
+		{
+			fds.clear();
+			pollfd listenFd = { tcpListen, POLLIN, 0 };
+			fds.push_back(listenFd);
+			for (auto& flow : flows)
+			{
+				if (flow->connecting)
+				{
+					//The client isn't read before the server can receive its data.
+					pollfd client = { flow->client, 0, 0 };
+					pollfd server = { flow->server, POLLOUT, 0 };
+					fds.push_back(client);
+					fds.push_back(server);
+					continue;
+				}
+				std::lock_guard<std::mutex> lg(flow->mutex);
+				//The client socket is read for the data to the server, and written with the data to the client.
+				pollfd client = { flow->client, pollEvents(flow->toServer, flow->toClient), 0 };
+				pollfd server = { flow->server, pollEvents(flow->toClient, flow->toServer), 0 };
+				fds.push_back(client);
+				fds.push_back(server);
+			}
+			if (pollSockets(fds.data(), fds.size(), PollTimeoutMs) < 0)
+			{
+				continue;
+			}
+
+			for (std::size_t i = 0; i < flows.size(); i++)
+			{
+				auto& flow = flows[i];
+				auto clientEvents = fds[1 + 2 * i].revents;
+				auto serverEvents = fds[2 + 2 * i].revents;
+				if (flow->connecting)
+				{
+					if (serverEvents & (POLLOUT | POLLHUP | POLLERR))
+					{
+						finishConnect(*flow);
+					}
+					continue;
+				}
+				if ((clientEvents | serverEvents) & POLLOUT)
+				{
+					std::lock_guard<std::mutex> lg(flow->mutex);
+					flush(*flow, flow->toClient);
+					flush(*flow, flow->toServer);
+				}
+				if (clientEvents & (POLLIN | POLLHUP | POLLERR))
+				{
+					read(flow, flow->toServer, buffer, random);
+				}
+				if (serverEvents & (POLLIN | POLLHUP | POLLERR))
+				{
+					read(flow, flow->toClient, buffer, random);
+				}
+			}
+
+			if (fds[0].revents & POLLIN)
+			{
+				auto client = accept(tcpListen, nullptr, nullptr);
+				if (client != InvalidSocket)
+				{
+					if (auto flow = startTcpFlow(client, random))
+					{
+						flows.push_back(flow);
+						counters.flows++;
+					}
+				}
+			}
+
+			//Flows whose both directions are closed, and whose data was written.
+			auto end = std::partition(flows.begin(), flows.end(), [](const std::shared_ptr<TcpFlow>& flow) {
+				std::lock_guard<std::mutex> lg(flow->mutex);
+				return !flow->toServer.done || !flow->toClient.done;
+			});
+			counters.flows -= static_cast<int>(flows.end() - end);
+			flows.erase(end, flows.end());
+		}
+
+		for (auto& flow : flows)
+		{
+			::shutdown(flow->client, ShutdownBoth);
+			::shutdown(flow->server, ShutdownBoth);
+		}
+		counters.flows -= static_cast<int>(flows.size());
+	}
+
+	//Connects to the server without blocking the poll loop: the flow is polled for the end of the connection.
+	std::shared_ptr<TcpFlow> startTcpFlow(Socket client, std::mt19937& random)
+	{
+		auto server = socket(AF_INET, SOCK_STREAM, 0);
+		auto connected = false;
+		auto pending = false;
+		if (server != InvalidSocket && setNonBlocking(server) && setNonBlocking(client))
+		{
+			connected = connect(server, reinterpret_cast<sockaddr*>(&tcpTarget), sizeof(tcpTarget)) == 0;
+			pending = !connected && connectPending();
+		}
+		if (!connected && !pending)
+		{
+			if (server != InvalidSocket)
+			{
+				closeSocket(server);
+			}
+			closeSocket(client);
+			return nullptr;
+		}
+
+		auto flow = std::make_shared<TcpFlow>();
+		flow->client = client;
+		flow->server = server;
+		flow->connecting = !connected;
+		flow->toServer.from = client;
+		flow->toServer.to = server;
+		flow->toClient.from = server;
+		flow->toClient.to = client;
+		flow->toServer.direction.baseLatency = drawBaseLatency(impairment, random);
+		flow->toClient.direction.baseLatency = flow->toServer.direction.baseLatency;
+		return flow;
+	}
+
+	//Called when the connection to the server completed or failed. A failed flow is closed, and removed with the flows whose both directions are done.
+	void finishConnect(TcpFlow& flow)
+	{
+		flow.connecting = false;
+		if (connectSucceeded(flow.server))
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lg(flow.mutex);
+		for (auto h : { &flow.toServer, &flow.toClient })
+		{
+			h->readClosed = true;
+			h->done = true;
+		}
+		::shutdown(flow.client, ShutdownBoth);
+	}
+
+	//Reads the data available on half.from, and schedules its delivery.
+	void read(std::shared_ptr<TcpFlow> flow, TcpHalf& half, std::vector<char>& buffer, std::mt19937& random)
+	{
+		{
+			std::lock_guard<std::mutex> lg(flow->mutex);
+			if (half.readClosed)
+			{
+				return;
+			}
+		}
+		auto n = recv(half.from, buffer.data(), static_cast<int>(buffer.size()), 0);
+		if (n < 0 && wouldBlock())
+		{
+			return;
+		}
+
+		//The direction is only used by the poll loop.
+		Clock::time_point at;
+		deliveryTime(impairment, half.direction, n > 0 ? n : 0, false, random, counters, at);
+		auto halfPtr = &half;
+		if (n <= 0)
+		{
+			{
+				std::lock_guard<std::mutex> lg(flow->mutex);
+				half.readClosed = true;
+			}
+			//Forwards the end of the stream once the data before it is delivered.
+			tcpLine->schedule(at, [this, flow, halfPtr]() {
+				std::lock_guard<std::mutex> lg(flow->mutex);
+				halfPtr->endDue = true;
+				flush(*flow, *halfPtr);
+			});
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lg(flow->mutex);
+			half.buffered += n;
+		}
+		std::vector<char> data(buffer.begin(), buffer.begin() + n);
+		tcpLine->schedule(at, [this, flow, halfPtr, data]() {
+			std::lock_guard<std::mutex> lg(flow->mutex);
+			halfPtr->outgoing.insert(halfPtr->outgoing.end(), data.begin(), data.end());
+			counters.forwarded++;
+			flush(*flow, *halfPtr);
+		});
+	}
+
+	//Writes the due data of a half without blocking, the poll loop writes the rest when the socket is writable. Called with the flow mutex held.
+	void flush(TcpFlow& flow, TcpHalf& half)
+	{
+		if (half.done)
+		{
+			return;
+		}
+		if (!half.outgoing.empty())
+		{
+			auto n = sendSome(half.to, half.outgoing.data(), half.outgoing.size());
+			if (n < 0)
+			{
+				//One side is gone: close both, dropping what is still delayed.
+				for (auto h : { &flow.toServer, &flow.toClient })
+				{
+					h->readClosed = true;
+					h->done = true;
+					h->outgoing.clear();
+				}
+				::shutdown(flow.client, ShutdownBoth);
+				::shutdown(flow.server, ShutdownBoth);
+				return;
+			}
+			half.outgoing.erase(half.outgoing.begin(), half.outgoing.begin() + n);
+			half.buffered -= n;
+			counters.bytes += n;
+		}
+		if (half.endDue && half.outgoing.empty())
+		{
+			::shutdown(half.to, ShutdownWrite);
+			half.done = true;
+		}
+	}
+};
+
+bool StressTool::Impairment::profile(const std::string& name, Impairment& result)
+{
+	//latency, jitter, latencySpread, loss, reorder, bandwidth (kbit/s)
+	static const std::map<std::string, Impairment> profiles = {
+		{ "none", Impairment{} },
+		{ "lan", Impairment{ 0.5, 0.1, 0, 0, 0, 0 } },
+		{ "cable", Impairment{ 10, 2, 0.3, 0.0005, 0, 50000 } },
+		{ "transatlantic", Impairment{ 45, 3, 0.1, 0.002, 0.001, 0 } },
+		{ "mobile4g", Impairment{ 40, 15, 0.5, 0.01, 0.005, 10000 } },
+		{ "mobile3g", Impairment{ 100, 40, 0.5, 0.03, 0.01, 1500 } },
+		{ "congested", Impairment{ 80, 60, 0.5, 0.05, 0.02, 1000 } }
+	};
+	auto it = profiles.find(name);
+	if (it == profiles.end())
+	{
+		return false;
+	}
+	result = it->second;
+	return true;
+}
+
+std::vector<std::string> StressTool::Impairment::profiles()
+{
+	return { "none", "lan", "cable", "transatlantic", "mobile4g", "mobile3g", "congested" };
+}
+
+StressTool::NetworkProxy::NetworkProxy(const Impairment& impairment, const std::string& targetHost)
+	: _impl(new Impl())
+{
+	_impl->impairment = impairment;
+	_impl->targetHost = targetHost;
+}
+
+StressTool::NetworkProxy::~NetworkProxy()
+{
+	stop();
+}
+
+bool StressTool::NetworkProxy::startUdp(int listenPort, int targetPort)
+{
+	if (!resolve(_impl->targetHost, targetPort, _impl->udpTarget))
+	{
+		_impl->error = "can't resolve " + _impl->targetHost;
+		return false;
+	}
+	_impl->udpListen = bindSocket(SOCK_DGRAM, listenPort);
+	if (_impl->udpListen == InvalidSocket)
+	{
+		_impl->error = "can't bind UDP port " + std::to_string(listenPort);
+		return false;
+	}
+	auto impl = _impl.get();
+	_impl->threads.emplace_back([impl]() { impl->udpLoop(); });
+	return true;
+}
+
+bool StressTool::NetworkProxy::startTcp(int listenPort, int targetPort)
+{
+	if (!resolve(_impl->targetHost, targetPort, _impl->tcpTarget))
+	{
+		_impl->error = "can't resolve " + _impl->targetHost;
+		return false;
+	}
+	_impl->tcpListen = bindSocket(SOCK_STREAM, listenPort);
+	if (_impl->tcpListen == InvalidSocket)
+	{
+		_impl->error = "can't listen on TCP port " + std::to_string(listenPort);
+		return false;
+	}
+	auto impl = _impl.get();
+	_impl->threads.emplace_back([impl]() { impl->tcpLoop(); });
+	return true;
+}
+
+void StressTool::NetworkProxy::stop()
+{
+	if (_impl->stopping.exchange(true))
+	{
+		return;
+	}
+	for (auto& thread : _impl->threads)
+	{
+		thread.join();
+	}
+	_impl->threads.clear();
+	//Drops the delayed data, and with it the last references to the flows.
+	_impl->udpLine.reset();
+	_impl->tcpLine.reset();
+
+	if (_impl->udpListen != InvalidSocket)
+	{
+		closeSocket(_impl->udpListen);
+	}
+	if (_impl->tcpListen != InvalidSocket)
+	{
+		closeSocket(_impl->tcpListen);
+	}
+}
+
+const std::string& StressTool::NetworkProxy::error() const
+{
+	return _impl->error;
+}
+
+const StressTool::NetworkProxy::Counters& StressTool::NetworkProxy::counters() const
+{
+	return _impl->counters;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Network conditions applied to each direction of each client flow going through the NetworkProxy.
+	/// </summary>
+	struct Impairment
+	{
+		//One way latency, in ms.
+		double latency = 0;
+		//Standard deviation of the latency, in ms.
+		double jitter = 0;
+		//The base latency of each client is drawn uniformly in [latency * (1 - latencySpread), latency * (1 + latencySpread)].
+		double latencySpread = 0;
+		//Probability that a datagram is dropped. UDP only.
+		double loss = 0;
+		//Probability that a datagram is delivered after the datagrams following it. UDP only.
+		double reorder = 0;
+		//Bandwidth cap per client and direction, in kbit/s. 0 for unlimited.
+		double bandwidth = 0;
+
+		/// <summary>
+		/// Gets a named profile, such as "mobile4g" or "transatlantic".
+		/// </summary>
+		/// <returns>false if the profile doesn't exist.</returns>
+		static bool profile(const std::string& name, Impairment& result);
+
+		static std::vector<std::string> profiles();
+	};
+
+	/// <summary>
+	/// UDP and TCP proxy delaying, dropping and reordering traffic between clients and a local server.
+	/// </summary>
+	/// <remarks>
+	/// Each UDP client address and each TCP connection is a separate flow with its own latency and bandwidth.
+	/// TCP flows only get latency, jitter and bandwidth caps: loss and reordering would be hidden by the proxy's own TCP stack.
+	/// One thread polls all the TCP connections and one thread per protocol delivers the delayed data, so connections don't cost threads.
+	/// Only client to server traffic is supported: each UDP flow is connected to the target, and clients send P2P traffic directly to their peers, so P2P doesn't go through the proxy.
+	/// </remarks>
+	class NetworkProxy
+	{
+	public:
+		NetworkProxy(const Impairment& impairment, const std::string& targetHost);
+		~NetworkProxy();
+
+		NetworkProxy(const NetworkProxy&) = delete;
+		NetworkProxy& operator=(const NetworkProxy&) = delete;
+
+		/// <summary>
+		/// Forwards datagrams received on listenPort to targetPort of the target host, and the answers back to their client.
+		/// </summary>
+		bool startUdp(int listenPort, int targetPort);
+
+		/// <summary>
+		/// Forwards connections accepted on listenPort to targetPort of the target host.
+		/// </summary>
+		bool startTcp(int listenPort, int targetPort);
+
+		void stop();
+
+		const std::string& error() const;
+
+		struct Counters
+		{
+			std::atomic<std::uint64_t> forwarded{ 0 };
+			std::atomic<std::uint64_t> bytes{ 0 };
+			std::atomic<std::uint64_t> dropped{ 0 };
+			std::atomic<std::uint64_t> reordered{ 0 };
+			std::atomic<int> flows{ 0 };
+		};
+
+		const Counters& counters() const;
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> _impl;
+	};
+}
@@ -0,0 +1,65 @@
+#include "Options.h"
+
+StressTool::Options::Options(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if (arg.rfind("--", 0) == 0)
+		{
+			auto separator = arg.find('=');
+			if (separator == std::string::npos)
+			{
+				//A flag without value is a boolean switch.
+				_values[arg.substr(2)] = "true";
+			}
+			else
+			{
+				_values[arg.substr(2, separator - 2)] = arg.substr(separator + 1);
+			}
+		}
+		else
+		{
+			_mode = arg;
+		}
+	}
+}
+
+const std::string& StressTool::Options::mode() const
+{
+	return _mode;
+}
+
+bool StressTool::Options::has(const std::string& name) const
+{
+	return _values.find(name) != _values.end();
+}
+
+std::string StressTool::Options::getString(const std::string& name, const std::string& defaultValue) const
+{
+	auto it = _values.find(name);
+	return it != _values.end() ? it->second : defaultValue;
+}
+
+int StressTool::Options::getInt(const std::string& name, int defaultValue) const
+{
+	auto it = _values.find(name);
+	return it != _values.end() ? std::stoi(it->second) : defaultValue;
+}
+
+double StressTool::Options::getDouble(const std::string& name, double defaultValue) const
+{
+	auto it = _values.find(name);
+	return it != _values.end() ? std::stod(it->second) : defaultValue;
+}
+
+bool StressTool::Options::getBool(const std::string& name, bool defaultValue) const
+{
+	auto it = _values.find(name);
+	return it != _values.end() ? (it->second == "true" || it->second == "1") : defaultValue;
+}
+
+const std::unordered_map<std::string, std::string>& StressTool::Options::values() const
+{
+	return _values;
+}
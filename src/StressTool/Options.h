@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Command line options of the stress tool.
+	/// </summary>
+	/// <remarks>
+	/// The first positional argument is the mode (defaults to "login"). Other arguments are read as --name=value.
+	/// </remarks>
+	class Options
+	{
+	public:
+		Options(int argc, char** argv);
+
+		const std::string& mode() const;
+
+		bool has(const std::string& name) const;
+		std::string getString(const std::string& name, const std::string& defaultValue) const;
+		int getInt(const std::string& name, int defaultValue) const;
+		double getDouble(const std::string& name, double defaultValue) const;
+		bool getBool(const std::string& name, bool defaultValue) const;
+
+		/// <summary>
+		/// All the --name=value options, as provided on the command line.
+		/// </summary>
+		const std::unordered_map<std::string, std::string>& values() const;
+
+	private:
+		std::string _mode = "login";
+		std::unordered_map<std::string, std::string> _values;
+	};
+}
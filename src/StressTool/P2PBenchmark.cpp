@@ -0,0 +1,177 @@
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "CountingLogger.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "Trace.h"
+//Provides APIs related to player parties.
+#include "Party/Party.hpp"
+#include "GameSession/Gamesessions.hpp"
+#include <iostream>
+
+namespace
+{
+	struct SessionResult
+	{
+		bool success = false;
+		bool isHost = false;
+		//From player ready to GameFoundEvent.
+		double gameFound = 0;
+		//From GameFoundEvent to connectToGameSession completion. For peers, this includes P2P connection to the host.
+		double connected = 0;
+		//From connectToGameSession completion to setPlayerReady completion.
+		double ready = 0;
+	};
+
+	//Records the consecutive steps of a client on the trace timeline.
+	struct Phases
+	{
+		int client;
+		StressTool::Trace::TimePoint start = StressTool::Trace::now();
+
+		void end(const char* name)
+		{
+			auto now = StressTool::Trace::now();
+			StressTool::Trace::span(name, client, start, now);
+			start = now;
+		}
+	};
+
+	pplx::task<SessionResult> joinGameSession(int id)
+	{
+		auto timer = std::make_shared<Timer>();
+		auto result = std::make_shared<SessionResult>();
+		auto phases = std::make_shared<Phases>();
+		phases->client = id;
+
+		return StressTool::Clients::login(id)
+		.then([timer, result, phases](std::shared_ptr<Stormancer::IClient> client) {
+			phases->end("login");
+			auto gameFinder = client->dependencyResolver().resolve<Stormancer::GameFinder::GameFinderApi>();
+			auto party = client->dependencyResolver().resolve<Stormancer::Party::PartyApi>();
+
+			//Create a task that will complete the next time a game is found.
+			auto gameFoundTask = gameFinder->waitGameFound();
+
+			Stormancer::Party::PartyRequestDto request;
+			request.GameFinderName = "matchmaking";
+
+			return party->createPartyIfNotJoined(request)
+				.then([party, timer, phases]() {
+					phases->end("createParty");
+					timer->start();
+					return party->updatePlayerStatus(Stormancer::Party::PartyUserStatus::Ready);
+				})
+				.then([gameFoundTask, phases]() {
+					phases->end("ready");
+					return gameFoundTask;
+				})
+				.then([client, timer, result, phases](Stormancer::GameFinder::GameFoundEvent evt) {
+					result->gameFound = timer->getElapsedTimeInMilliSec();
+					phases->end("gameFound");
+					timer->start();
+					auto gameSessions = client->dependencyResolver().resolve<Stormancer::GameSessions::GameSession>();
+					return gameSessions->connectToGameSession(evt.data.connectionToken);
+				})
+				.then([client, timer, result, phases](Stormancer::GameSessions::GameSessionConnectionParameters params) {
+					result->connected = timer->getElapsedTimeInMilliSec();
+					phases->end("sessionJoined");
+					result->isHost = params.isHost;
+					timer->start();
+					auto gameSessions = client->dependencyResolver().resolve<Stormancer::GameSessions::GameSession>();
+					return gameSessions->setPlayerReady();
+				});
+		})
+		//The client is released by the caller once every session completed: a host released here would tear down its session while the peer still connects to it.
+		.then([timer, result, phases](pplx::task<void> t) {
+			try
+			{
+				t.get();
+				result->ready = timer->getElapsedTimeInMilliSec();
+				phases->end("playerReady");
+				result->success = true;
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				result->success = false;
+			}
+			return *result;
+		});
+	}
+
+	void printPhase(const char* name, const char* metric, const std::vector<SessionResult>& results, bool isHost, double SessionResult::* phase)
+	{
+		std::vector<StressTool::Result> values;
+		for (auto& r : results)
+		{
+			if (r.success && r.isHost == isHost)
+			{
+				StressTool::Result v;
+				v.success = true;
+				v.duration = r.*phase;
+				values.push_back(v);
+			}
+		}
+		auto s = StressTool::stats(values);
+		StressTool::RunReport::record(std::string("p2p.") + (isHost ? "host." : "peer.") + metric, values);
+		std::cout << (isHost ? "host " : "peer ") << name << " n=" << s.count << " p50=" << s.p50 << "ms p90=" << s.p90 << "ms p99=" << s.p99 << "ms max=" << s.max << "ms\n";
+	}
+}
+
+int StressTool::runP2PBenchmark(const Options& options)
+{
+	auto nbSessions = options.getInt("sessions", 50);
+	auto punchCounter = std::make_shared<std::atomic<std::uint64_t>>(0);
+	auto punchPattern = options.getString("punchPattern", "punch");
+	//The client API doesn't expose NAT traversal attempts, count them from the library logs.
+	auto logger = std::make_shared<CountingLogger>(punchPattern, punchCounter);
+
+	ConfigurationTemplate()
+		.addPlugin<Stormancer::Party::PartyPlugin>()
+		.addPlugin<Stormancer::GameFinder::GameFinderPlugin>()
+		.addPlugin<Stormancer::GameSessions::GameSessionsPlugin>()
+		.configure([logger](Stormancer::Configuration& config) {
+			config.logger = logger;
+			//If tunnel is enabled in gamesessions, serverGamePort contains the port the game server is expected to bind to by the P2P tunnel.
+			config.serverGamePort = 7777;
+		})
+		.install();
+
+	std::vector<pplx::task<SessionResult>> tasks;
+	//The matchmaker creates sessions of 2 players.
+	for (int i = 0; i < nbSessions * 2; i++)
+	{
+		tasks.push_back(joinGameSession(i));
+	}
+	auto results = pplx::when_all(tasks.begin(), tasks.end()).get();
+	for (int i = 0; i < nbSessions * 2; i++)
+	{
+		Stormancer::IClientFactory::ReleaseClient(i);
+	}
+
+	std::size_t succeeded = 0;
+	for (auto& r : results)
+	{
+		if (r.success)
+		{
+			succeeded++;
+		}
+	}
+
+	addCompletedOperations(succeeded);
+	RunReport::setCounter("p2p.natPunchAttemptsPerSession", static_cast<double>(*punchCounter) / nbSessions);
+
+	std::cout << "p2p session benchmark " << options.getString("label", "") << "\n";
+	std::cout << "success rate       : " << 100.0 * succeeded / results.size() << "%\n";
+	std::cout << "nat punch attempts : " << static_cast<double>(*punchCounter) / nbSessions << " per session (log pattern '" << punchPattern << "')\n";
+	for (auto isHost : { true, false })
+	{
+		printPhase("ready->gameFound     ", "gameFound", results, isHost, &SessionResult::gameFound);
+		printPhase("gameFound->connected ", "connected", results, isHost, &SessionResult::connected);
+		printPhase("connected->ready     ", "ready", results, isHost, &SessionResult::ready);
+	}
+	return 0;
+}
@@ -0,0 +1,15 @@
+#include "Pacer.h"
+#include <thread>
+
+StressTool::Pacer::Pacer(double operationsPerSecond)
+	: _interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / operationsPerSecond)))
+	, _next(std::chrono::steady_clock::now())
+{
+}
+
+void StressTool::Pacer::wait()
+{
+	//Schedule against the theoretical timeline instead of now(), so that a late wakeup doesn't lower the offered rate.
+	std::this_thread::sleep_until(_next);
+	_next += _interval;
+}
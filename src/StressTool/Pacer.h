@@ -0,0 +1,23 @@
+#pragma once
+#include <chrono>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Spaces operations at a fixed rate (open loop), independently of how long each operation takes.
+	/// </summary>
+	class Pacer
+	{
+	public:
+		Pacer(double operationsPerSecond);
+
+		/// <summary>
+		/// Blocks until the next operation is due.
+		/// </summary>
+		void wait();
+
+	private:
+		std::chrono::steady_clock::duration _interval;
+		std::chrono::steady_clock::time_point _next;
+	};
+}
@@ -0,0 +1,254 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+//Provides APIs related to player parties.
+#include "Party/Party.hpp"
+#include "GameSession/Gamesessions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+	using Metric = std::vector<StressTool::Result>;
+
+	struct ChurnState
+	{
+		std::mutex mutex;
+		Metric creates;
+		Metric codes;
+		Metric joins;
+		Metric leaves;
+	};
+
+	struct PartyContext
+	{
+		//The leader is the first member.
+		std::vector<int> ids;
+		std::vector<std::shared_ptr<Stormancer::Party::PartyApi>> members;
+		//Indices of the members currently out of the party. Guarded by ChurnState::mutex.
+		std::vector<std::size_t> outside;
+	};
+
+	void record(ChurnState& state, Metric ChurnState::* metric, std::shared_ptr<Timer> timer, bool success)
+	{
+		StressTool::Result r;
+		r.duration = timer->getElapsedTimeInMilliSec();
+		r.success = success;
+		std::lock_guard<std::mutex> lg(state.mutex);
+		(state.*metric).push_back(r);
+	}
+
+	template<typename T>
+	bool succeeded(pplx::task<T>& t)
+	{
+		try
+		{
+			t.get();
+			return true;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << ex.what() << "\n";
+			return false;
+		}
+	}
+
+	std::shared_ptr<Timer> startTimer()
+	{
+		auto timer = std::make_shared<Timer>();
+		timer->start();
+		return timer;
+	}
+
+	//Members outside of the party redeem the code concurrently. Those who fail stay outside and retry with the next code.
+	pplx::task<void> joinAll(std::shared_ptr<ChurnState> state, std::shared_ptr<PartyContext> party, std::string code)
+	{
+		std::vector<std::size_t> joining;
+		{
+			std::lock_guard<std::mutex> lg(state->mutex);
+			joining.swap(party->outside);
+		}
+		std::vector<pplx::task<void>> tasks;
+		for (auto index : joining)
+		{
+			auto timer = startTimer();
+			tasks.push_back(party->members[index]->joinPartyByInvitationCode(code).then([state, party, index, timer](pplx::task<void> t) {
+				auto success = succeeded(t);
+				record(*state, &ChurnState::joins, timer, success);
+				if (!success)
+				{
+					std::lock_guard<std::mutex> lg(state->mutex);
+					party->outside.push_back(index);
+				}
+			}));
+		}
+		return pplx::when_all(tasks.begin(), tasks.end());
+	}
+
+	//Members leave in turn, so that every member churns over the rounds. The leader stays.
+	pplx::task<void> leaveSome(std::shared_ptr<ChurnState> state, std::shared_ptr<PartyContext> party, int round, std::size_t leaving)
+	{
+		std::vector<std::size_t> inside;
+		{
+			std::lock_guard<std::mutex> lg(state->mutex);
+			for (std::size_t i = 1; i < party->members.size(); i++)
+			{
+				if (std::find(party->outside.begin(), party->outside.end(), i) == party->outside.end())
+				{
+					inside.push_back(i);
+				}
+			}
+		}
+		std::vector<pplx::task<void>> tasks;
+		for (std::size_t i = 0; i < std::min(leaving, inside.size()); i++)
+		{
+			auto index = inside[(round * leaving + i) % inside.size()];
+			auto timer = startTimer();
+			tasks.push_back(party->members[index]->leaveParty().then([state, party, index, timer](pplx::task<void> t) {
+				auto success = succeeded(t);
+				record(*state, &ChurnState::leaves, timer, success);
+				if (success)
+				{
+					std::lock_guard<std::mutex> lg(state->mutex);
+					party->outside.push_back(index);
+				}
+			}));
+		}
+		return pplx::when_all(tasks.begin(), tasks.end());
+	}
+
+	//Each round, the leader creates a new code, members outside join with it, then some members leave.
+	pplx::task<void> runRounds(std::shared_ptr<ChurnState> state, std::shared_ptr<PartyContext> party, int round, int rounds, std::size_t leaving)
+	{
+		if (round >= rounds)
+		{
+			return pplx::task_from_result();
+		}
+		auto timer = startTimer();
+		return party->members[0]->createInvitationCode().then([state, party, timer](pplx::task<std::string> t) {
+			auto success = succeeded(t);
+			record(*state, &ChurnState::codes, timer, success);
+			return success ? joinAll(state, party, t.get()) : pplx::task_from_result();
+		})
+		.then([state, party, round, leaving]() {
+			return leaveSome(state, party, round, leaving);
+		})
+		.then([state, party, round, rounds, leaving]() {
+			return runRounds(state, party, round + 1, rounds, leaving);
+		});
+	}
+
+	pplx::task<void> runParty(std::shared_ptr<ChurnState> state, std::shared_ptr<PartyContext> party, int rounds, std::size_t leaving)
+	{
+		std::vector<pplx::task<std::shared_ptr<Stormancer::IClient>>> logins;
+		for (auto id : party->ids)
+		{
+			logins.push_back(StressTool::Clients::login(id));
+		}
+		return pplx::when_all(logins.begin(), logins.end()).then([state, party](std::vector<std::shared_ptr<Stormancer::IClient>> clients) {
+			for (std::size_t i = 0; i < clients.size(); i++)
+			{
+				party->members.push_back(clients[i]->dependencyResolver().resolve<Stormancer::Party::PartyApi>());
+				if (i > 0)
+				{
+					party->outside.push_back(i);
+				}
+			}
+
+			Stormancer::Party::PartyRequestDto request;
+			request.GameFinderName = "matchmaking";
+			auto timer = startTimer();
+			return party->members[0]->createPartyIfNotJoined(request).then([state, timer](pplx::task<void> t) {
+				auto success = succeeded(t);
+				record(*state, &ChurnState::creates, timer, success);
+				if (!success)
+				{
+					throw std::runtime_error("party creation failed");
+				}
+			});
+		})
+		.then([state, party, rounds, leaving]() {
+			return runRounds(state, party, 0, rounds, leaving);
+		})
+		.then([party](pplx::task<void> t) {
+			succeeded(t);
+			for (auto id : party->ids)
+			{
+				Stormancer::IClientFactory::ReleaseClient(id);
+			}
+		});
+	}
+
+	void printMetric(const char* name, const Metric& values)
+	{
+		auto s = StressTool::stats(values);
+		StressTool::RunReport::record(std::string("party.") + name, values);
+		std::cout << std::setw(7) << std::left << name << std::right << "n=" << values.size() << " success=" << s.successRate * 100 << "% p50=" << s.p50 << "ms p90=" << s.p90 << "ms p99=" << s.p99 << "ms max=" << s.max << "ms\n";
+	}
+}
+
+int StressTool::runPartyChurnBenchmark(const Options& options)
+{
+	auto parties = options.getInt("parties", 50);
+	auto size = std::max(2, options.getInt("size", 4));
+	auto rounds = options.getInt("rounds", 10);
+	//Fraction of the members other than the leader leaving after each round, to rejoin with the next code.
+	auto churn = options.getDouble("churn", 0.5);
+	//Parties started per second, 0 to start them all at once.
+	auto rate = options.getDouble("rate", 0);
+	auto leaving = static_cast<std::size_t>(std::ceil(churn * (size - 1)));
+
+	ConfigurationTemplate()
+		.addPlugin<Stormancer::Party::PartyPlugin>()
+		.addPlugin<Stormancer::GameFinder::GameFinderPlugin>()
+		.addPlugin<Stormancer::GameSessions::GameSessionsPlugin>()
+		.install();
+
+	auto state = std::make_shared<ChurnState>();
+	std::vector<pplx::task<void>> tasks;
+	Pacer pacer(rate > 0 ? rate : 1);
+	Timer timer;
+	timer.start();
+	for (int p = 0; p < parties; p++)
+	{
+		if (rate > 0)
+		{
+			pacer.wait();
+		}
+		auto party = std::make_shared<PartyContext>();
+		for (int i = 0; i < size; i++)
+		{
+			party->ids.push_back(p * size + i);
+		}
+		tasks.push_back(runParty(state, party, rounds, leaving));
+	}
+	pplx::when_all(tasks.begin(), tasks.end()).wait();
+	auto elapsed = timer.getElapsedTimeInSec();
+
+	std::size_t operations = 0;
+	for (auto metric : { &state->creates, &state->codes, &state->joins, &state->leaves })
+	{
+		for (auto& r : *metric)
+		{
+			operations += r.success ? 1 : 0;
+		}
+	}
+	addCompletedOperations(operations);
+	RunReport::setCounter("party.operationsPerSecond", operations / elapsed);
+
+	std::cout << "party churn: " << parties << " parties of " << size << ", " << rounds << " rounds, " << leaving << " members leaving per round\n";
+	printMetric("create", state->creates);
+	printMetric("code", state->codes);
+	printMetric("join", state->joins);
+	printMetric("leave", state->leaves);
+	std::cout << "party operations/s : " << operations / elapsed << "\n";
+	return 0;
+}
@@ -0,0 +1,70 @@
+#define NOMINMAX
+#include "Allocations.h"
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Echo.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include <algorithm>
+#include <iostream>
+
+int StressTool::runPayloadSweepBenchmark(const Options& options)
+{
+	auto window = options.getInt("window", 16);
+	auto messages = options.getInt("messages", 1000);
+	auto minSize = options.getInt("minSize", 16);
+	auto maxSize = options.getInt("maxSize", 256 * 1024);
+	//Caps the volume sent for large payloads, so that a sweep doesn't take hours.
+	auto maxBytesPerSize = options.getDouble("maxMBPerSize", 256) * 1024 * 1024;
+
+	ConfigurationTemplate().install();
+	std::shared_ptr<Stormancer::RpcService> rpc;
+	try
+	{
+		auto scene = Clients::login(0).then([](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene("test-scene");
+		}).get();
+		rpc = scene->dependencyResolver().resolve<Stormancer::RpcService>();
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "failed to connect: " << ex.what() << "\n";
+		Stormancer::IClientFactory::ReleaseClient(0);
+		return 1;
+	}
+
+	std::cout << "payload sweep, window=" << window << (Allocations::enabled() ? "" : " (build with STRESSTOOL_TRACK_ALLOCATIONS to count allocations)") << "\n";
+	std::cout << "size(B)\tmsgs/s\tMB/s\tp50(ms)\tp90(ms)\tp99(ms)\tmax(ms)\tsuccess\tallocs/msg\tKB alloc/msg\n";
+	for (int size = minSize; size <= maxSize; size *= 2)
+	{
+		auto state = std::make_shared<EchoState>();
+		state->rpc = rpc;
+		state->payload = std::string(size, 'x');
+		auto count = std::max(window, std::min(messages, static_cast<int>(maxBytesPerSize / size)));
+		state->remaining = count;
+		state->results.reserve(count);
+
+		auto allocationsBefore = Allocations::snapshot();
+		Timer timer;
+		timer.start();
+		runEcho(state, window).wait();
+		timer.stop();
+		auto allocationsAfter = Allocations::snapshot();
+
+		auto s = stats(state->results);
+		addCompletedOperations(s.count);
+		auto elapsed = timer.getElapsedTimeInSec();
+		auto throughput = s.count / elapsed;
+		RunReport::record("payload." + std::to_string(size), state->results);
+		RunReport::setCounter("payload." + std::to_string(size) + ".msgsPerSecond", throughput);
+		std::cout << size << "\t" << throughput << "\t" << throughput * size / (1024 * 1024) << "\t"
+			<< s.p50 << "\t" << s.p90 << "\t" << s.p99 << "\t" << s.max << "\t" << s.successRate * 100 << "%\t"
+			<< static_cast<double>(allocationsAfter.count - allocationsBefore.count) / count << "\t"
+			<< static_cast<double>(allocationsAfter.bytes - allocationsBefore.bytes) / count / 1024 << "\n";
+	}
+
+	Stormancer::IClientFactory::ReleaseClient(0);
+	return 0;
+}
@@ -0,0 +1,225 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "PeerConfiguration/PeerConfiguration.hpp"
+#include "stormancer/RPC/Service.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Receiver
+	{
+		std::mutex mutex;
+		bool hasInitial = false;
+		bool updated = false;
+		Clock::time_point updatedAt;
+		//Configurations received after the update was requested, including the update, and their total size.
+		int pushes = 0;
+		std::size_t bytes = 0;
+		Stormancer::Subscription subscription;
+	};
+
+	struct PushState
+	{
+		std::vector<std::shared_ptr<Receiver>> receivers;
+		std::atomic<int> initialReceived{ 0 };
+		std::atomic<int> updateReceived{ 0 };
+		//Unique value in the updated configuration, set before triggered and not modified after.
+		std::string revision;
+		std::atomic<bool> triggered{ false };
+	};
+
+	//The first configuration is sent after login. Once the update is requested, the update is the first configuration containing its revision.
+	void onConfiguration(std::shared_ptr<PushState> state, std::shared_ptr<Receiver> receiver, const std::string& config)
+	{
+		auto now = Clock::now();
+		std::lock_guard<std::mutex> lg(receiver->mutex);
+		if (!receiver->hasInitial)
+		{
+			receiver->hasInitial = true;
+			state->initialReceived++;
+		}
+		else if (state->triggered)
+		{
+			receiver->pushes++;
+			receiver->bytes += config.size();
+			if (!receiver->updated && config.find(state->revision) != std::string::npos)
+			{
+				receiver->updated = true;
+				receiver->updatedAt = now;
+				state->updateReceived++;
+			}
+		}
+	}
+
+	bool waitFor(const std::atomic<int>& counter, int expected, double timeout)
+	{
+		auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+		while (counter < expected && Clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return counter >= expected;
+	}
+}
+
+int StressTool::runPeerConfigurationBenchmark(const Options& options)
+{
+	auto clients = options.getInt("clients", 1000);
+	//Logins per second, 0 for all at once.
+	auto rate = options.getDouble("rate", 200);
+	//Size of the padding added to the updated configuration.
+	auto size = options.getInt("size", 1024);
+	//Must match stressTool.adminKey in the application configuration, which enables Test.UpdatePeerConfiguration.
+	auto adminKey = options.getString("adminKey", "");
+	auto timeout = options.getDouble("timeout", 60);
+
+	ConfigurationTemplate()
+		.addPlugin<Stormancer::PeerConfiguration::PeerConfigurationPlugin>()
+		.install();
+
+	auto state = std::make_shared<PushState>();
+	std::vector<pplx::task<std::shared_ptr<Stormancer::IClient>>> logins;
+	Pacer pacer(rate > 0 ? rate : 1);
+	for (int id = 0; id < clients; id++)
+	{
+		if (rate > 0)
+		{
+			pacer.wait();
+		}
+		auto receiver = std::make_shared<Receiver>();
+		state->receivers.push_back(receiver);
+		//Subscribe before login, to receive the configuration sent when the client logs in.
+		auto peerConfig = Stormancer::IClientFactory::GetClient(id)->dependencyResolver().resolve<Stormancer::PeerConfiguration::PeerConfigurationApi>();
+		std::weak_ptr<Receiver> weakReceiver = receiver;
+		receiver->subscription = peerConfig->subscribe([state, weakReceiver](std::string config) {
+			if (auto receiver = weakReceiver.lock())
+			{
+				onConfiguration(state, receiver, config);
+			}
+		});
+		logins.push_back(Clients::login(id));
+	}
+
+	int loggedIn = 0;
+	for (auto& login : logins)
+	{
+		try
+		{
+			login.get();
+			loggedIn++;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << ex.what() << "\n";
+		}
+	}
+	if (!waitFor(state->initialReceived, loggedIn, timeout))
+	{
+		std::cout << "only " << state->initialReceived << " of " << loggedIn << " clients received the initial configuration\n";
+	}
+
+	auto release = [clients]() {
+		//Includes the extra client requesting the update.
+		for (int id = 0; id <= clients; id++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(id);
+		}
+	};
+
+	//An extra client, not subscribed, requests the update.
+	auto updaterId = clients;
+	std::shared_ptr<Stormancer::RpcService> rpc;
+	try
+	{
+		auto scene = Clients::login(updaterId).then([](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene("test-scene");
+		}).get();
+		rpc = scene->dependencyResolver().resolve<Stormancer::RpcService>();
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "failed to connect the client updating the configuration: " << ex.what() << "\n";
+		release();
+		return 1;
+	}
+
+	auto subscribed = state->initialReceived.load();
+	std::cout << subscribed << " clients subscribed, updating the configuration\n";
+	state->revision = "stresstool-" + std::to_string(Clock::now().time_since_epoch().count());
+	auto configuration = "{\"revision\":\"" + state->revision + "\",\"padding\":\"" + std::string(size, 'x') + "\"}";
+	state->triggered = true;
+	auto triggeredAt = Clock::now();
+	try
+	{
+		rpc->rpc<void>("Test.UpdatePeerConfiguration", adminKey, configuration).get();
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "Test.UpdatePeerConfiguration failed: " << ex.what() << "\n";
+		release();
+		return 1;
+	}
+	auto updateCall = std::chrono::duration<double, std::milli>(Clock::now() - triggeredAt).count();
+
+	waitFor(state->updateReceived, subscribed, timeout);
+	//Leave time to count duplicate pushes.
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	std::vector<Clock::time_point> arrivals;
+	std::vector<double> bytes;
+	int pushes = 0;
+	for (auto& receiver : state->receivers)
+	{
+		std::lock_guard<std::mutex> lg(receiver->mutex);
+		if (receiver->updated)
+		{
+			arrivals.push_back(receiver->updatedAt);
+			bytes.push_back(static_cast<double>(receiver->bytes));
+			pushes += receiver->pushes;
+		}
+	}
+	release();
+	if (arrivals.empty())
+	{
+		std::cout << "no client received an updated configuration within " << timeout << "s\n";
+		return 1;
+	}
+
+	std::vector<Result> latencies;
+	for (auto& arrival : arrivals)
+	{
+		Result r;
+		r.success = true;
+		r.duration = std::chrono::duration<double, std::milli>(arrival - triggeredAt).count();
+		latencies.push_back(r);
+	}
+	auto s = stats(latencies);
+	std::sort(bytes.begin(), bytes.end());
+	addCompletedOperations(arrivals.size());
+	RunReport::record("peerConfig.delivery", latencies);
+	RunReport::setCounter("peerConfig.lastDelivery", s.max);
+	RunReport::setCounter("peerConfig.deliveredRatio", static_cast<double>(arrivals.size()) / subscribed);
+	RunReport::setCounter("peerConfig.updateCall", updateCall);
+	RunReport::setCounter("peerConfig.bytesPerClient.p50", percentile(bytes, 50));
+	RunReport::setCounter("peerConfig.bytesPerClient.max", bytes.back());
+
+	std::cout << "delivered to    : " << arrivals.size() << "/" << subscribed << " clients\n";
+	std::cout << "update call     : " << updateCall << "ms\n";
+	std::cout << "delivery        : p50=" << s.p50 << "ms p90=" << s.p90 << "ms p99=" << s.p99 << "ms, from the update call\n";
+	std::cout << "last client     : " << s.max << "ms\n";
+	std::cout << "bytes/client    : p50=" << percentile(bytes, 50) << " max=" << bytes.back() << " B (configurations received after the update call, without protocol framing)\n";
+	std::cout << "pushes/client   : " << static_cast<double>(pushes) / arrivals.size() << "\n";
+	return arrivals.size() == static_cast<std::size_t>(subscribed) ? 0 : 1;
+}
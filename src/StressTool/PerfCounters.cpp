@@ -0,0 +1,309 @@
+#include "PerfCounters.h"
+#include "Affinity.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+	const char* CounterNames[StressTool::PerfCounters::CounterCount] = { "cycles", "instructions", "cache-misses", "context-switches" };
+
+#ifdef __linux__
+	const std::uint32_t CounterTypes[StressTool::PerfCounters::CounterCount] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+	const std::uint64_t CounterConfigs[StressTool::PerfCounters::CounterCount] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES };
+
+	int openCounter(int tid, std::uint32_t type, std::uint64_t config)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		//Excluding the kernel allows counting with the default perf_event_paranoid setting (2).
+		attr.exclude_kernel = type == PERF_TYPE_HARDWARE;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		return static_cast<int>(syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0));
+	}
+
+	//Returns false if the thread exited.
+	bool threadStartTime(int tid, std::uint64_t& startTime)
+	{
+		std::ifstream stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+		std::string line;
+		if (!std::getline(stat, line))
+		{
+			return false;
+		}
+		//The name (field 2) is between parentheses and may contain spaces: fields are counted from the last ')'.
+		auto end = line.rfind(')');
+		if (end == std::string::npos)
+		{
+			return false;
+		}
+		std::istringstream fields(line.substr(end + 1));
+		std::string field;
+		//Fields 3 to 21.
+		for (int i = 3; i < 22; i++)
+		{
+			fields >> field;
+		}
+		return static_cast<bool>(fields >> startTime);
+	}
+
+	std::string threadName(int tid)
+	{
+		std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+		std::string name;
+		std::getline(comm, name);
+		return name;
+	}
+#endif
+}
+
+StressTool::PerfCounters::PerfCounters()
+{
+#ifndef __linux__
+	_available = false;
+	_error = "hardware counters are only supported on Linux";
+#endif
+}
+
+StressTool::PerfCounters::~PerfCounters()
+{
+	if (_running)
+	{
+		stop();
+	}
+}
+
+void StressTool::PerfCounters::start()
+{
+	if (!_available)
+	{
+		return;
+	}
+	scan();
+	if (!_available)
+	{
+		return;
+	}
+	_running = true;
+	_scanner = std::thread([this]() {
+		Affinity::pinMeasuringThread();
+#ifdef __linux__
+		_scannerTid = static_cast<int>(syscall(SYS_gettid));
+#endif
+		while (_running)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			scan();
+		}
+	});
+}
+
+void StressTool::PerfCounters::stop()
+{
+	if (!_running)
+	{
+		return;
+	}
+	_running = false;
+	_scanner.join();
+
+#ifdef __linux__
+	std::lock_guard<std::mutex> lg(_mutex);
+	for (auto& thread : _threads)
+	{
+		closeCounters(thread);
+	}
+#endif
+}
+
+void StressTool::PerfCounters::closeCounters(ThreadCounters& thread)
+{
+#ifdef __linux__
+	for (std::size_t i = 0; i < CounterCount; i++)
+	{
+		if (thread.fds[i] != -1)
+		{
+			//The counter of a thread that exited keeps its final value.
+			//With read_format, a read returns the value, then the time enabled and the time running.
+			std::uint64_t data[3] = {};
+			if (read(thread.fds[i], data, sizeof(data)) == sizeof(data))
+			{
+				thread.enabled[i] = data[1];
+				thread.running[i] = data[2];
+				//A multiplexed counter only counted while running: extrapolate to the time enabled.
+				thread.values[i] = data[2] > 0 ? static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : 0;
+			}
+			close(thread.fds[i]);
+			thread.fds[i] = -1;
+		}
+	}
+#endif
+}
+
+void StressTool::PerfCounters::scan()
+{
+#ifdef __linux__
+	//Live threads, with their start time.
+	std::vector<std::pair<int, std::uint64_t>> tids;
+	if (auto dir = opendir("/proc/self/task"))
+	{
+		while (auto entry = readdir(dir))
+		{
+			std::uint64_t startTime;
+			if (entry->d_name[0] != '.' && threadStartTime(std::atoi(entry->d_name), startTime))
+			{
+				tids.emplace_back(std::atoi(entry->d_name), startTime);
+			}
+		}
+		closedir(dir);
+	}
+
+	std::lock_guard<std::mutex> lg(_mutex);
+	//Threads that exited keep their values, but not their file descriptors.
+	for (auto& thread : _threads)
+	{
+		if (std::find(tids.begin(), tids.end(), std::make_pair(thread.tid, thread.startTime)) == tids.end())
+		{
+			closeCounters(thread);
+		}
+	}
+
+	for (auto& t : tids)
+	{
+		auto tid = t.first;
+		//Don't count the scanner thread itself.
+		if (tid == _scannerTid)
+		{
+			continue;
+		}
+		if (std::any_of(_threads.begin(), _threads.end(), [&t](const ThreadCounters& thread) { return thread.tid == t.first && thread.startTime == t.second; }))
+		{
+			continue;
+		}
+
+		ThreadCounters thread;
+		thread.tid = tid;
+		thread.startTime = t.second;
+		thread.name = threadName(tid);
+		auto opened = 0;
+		for (std::size_t i = 0; i < CounterCount; i++)
+		{
+			thread.values[i] = 0;
+			thread.enabled[i] = 0;
+			thread.running[i] = 0;
+			thread.fds[i] = openCounter(tid, CounterTypes[i], CounterConfigs[i]);
+			if (thread.fds[i] != -1)
+			{
+				opened++;
+			}
+			else if (_threads.empty() && (errno == EACCES || errno == EPERM))
+			{
+				_error = std::string("perf_event_open not permitted (") + std::strerror(errno) + "), check /proc/sys/kernel/perf_event_paranoid";
+				_available = false;
+			}
+		}
+		if (!_available)
+		{
+			for (auto fd : thread.fds)
+			{
+				if (fd != -1)
+				{
+					close(fd);
+				}
+			}
+			return;
+		}
+		//Counters that can't be opened (no PMU in a VM for instance) are reported as unavailable.
+		if (opened > 0)
+		{
+			_threads.push_back(thread);
+		}
+	}
+#endif
+}
+
+bool StressTool::PerfCounters::available() const
+{
+	return _available;
+}
+
+const std::string& StressTool::PerfCounters::error() const
+{
+	return _error;
+}
+
+void StressTool::PerfCounters::print(std::ostream& out, std::uint64_t operations) const
+{
+	if (!_available)
+	{
+		out << "perf counters unavailable : " << _error << "\n";
+		return;
+	}
+
+	std::uint64_t totals[CounterCount] = {};
+	std::uint64_t enabled[CounterCount] = {};
+	std::uint64_t running[CounterCount] = {};
+	bool measured[CounterCount] = {};
+	for (auto& thread : _threads)
+	{
+		for (std::size_t i = 0; i < CounterCount; i++)
+		{
+			totals[i] += thread.values[i];
+			enabled[i] += thread.enabled[i];
+			running[i] += thread.running[i];
+			measured[i] = measured[i] || thread.values[i] > 0;
+		}
+	}
+
+	out << "perf counters (" << _threads.size() << " threads, " << operations << " operations)\n";
+	for (std::size_t i = 0; i < CounterCount; i++)
+	{
+		out << "  " << CounterNames[i] << " : ";
+		if (!measured[i])
+		{
+			out << "n/a\n";
+			continue;
+		}
+		out << totals[i];
+		if (operations > 0)
+		{
+			out << " (" << static_cast<double>(totals[i]) / operations << " per operation)";
+		}
+		if (running[i] < enabled[i])
+		{
+			out << " [multiplexed, scaled from " << 100.0 * running[i] / enabled[i] << "% of the time]";
+		}
+		out << "\n";
+	}
+	if (measured[0] && measured[1])
+	{
+		out << "  IPC : " << static_cast<double>(totals[1]) / totals[0] << "\n";
+	}
+
+	auto threads = _threads;
+	std::sort(threads.begin(), threads.end(), [](const ThreadCounters& a, const ThreadCounters& b) { return a.values[0] > b.values[0]; });
+	out << "  busiest threads (tid name cycles instructions cache-misses context-switches)\n";
+	for (std::size_t t = 0; t < std::min<std::size_t>(threads.size(), 10); t++)
+	{
+		out << "    " << threads[t].tid << " " << threads[t].name;
+		for (std::size_t i = 0; i < CounterCount; i++)
+		{
+			out << " " << threads[t].values[i];
+		}
+		out << "\n";
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Hardware and scheduler counters (cycles, instructions, cache misses, context switches) of every thread of the process, read with perf_event_open.
+	/// </summary>
+	/// <remarks>
+	/// Most threads are created by the client library (pplx pool, network threads), so counters are opened on each thread found in /proc/self/task.
+	/// Threads are rescanned every 100ms while counting, threads living less than that are missed.
+	/// The counters of threads that exited are read and closed by the next scan, their values stay in the totals.
+	/// Threads are identified by their tid and start time, so that a tid reused by a new thread gets its own counters.
+	/// When the PMU has fewer registers than counters, the kernel multiplexes them: values are scaled by the fraction of time each counter ran.
+	/// Only available on Linux. If perf is not permitted, available() returns false and the benchmarks run normally.
+	/// </remarks>
+	class PerfCounters
+	{
+	public:
+		static constexpr std::size_t CounterCount = 4;
+
+		PerfCounters();
+		~PerfCounters();
+
+		/// <summary>
+		/// Starts counting on all current and future threads of the process.
+		/// </summary>
+		void start();
+
+		/// <summary>
+		/// Stops counting and reads the counters.
+		/// </summary>
+		void stop();
+
+		bool available() const;
+
+		/// <summary>
+		/// Reason why counters are not available.
+		/// </summary>
+		const std::string& error() const;
+
+		/// <summary>
+		/// Prints the totals normalized per completed operation, followed by the threads that used the most cycles.
+		/// </summary>
+		void print(std::ostream& out, std::uint64_t operations) const;
+
+	private:
+		struct ThreadCounters
+		{
+			int tid;
+			//Start time of the thread in clock ticks since boot, field 22 of /proc/self/task/<tid>/stat.
+			std::uint64_t startTime;
+			std::string name;
+			int fds[CounterCount];
+			//Scaled values, and the time the counter was enabled and actually counting, in ns.
+			std::uint64_t values[CounterCount];
+			std::uint64_t enabled[CounterCount];
+			std::uint64_t running[CounterCount];
+		};
+
+		void scan();
+		//Reads the final values of the counters of a thread and closes them.
+		static void closeCounters(ThreadCounters& thread);
+
+		//Written by the scanner thread when perf turns out not to be permitted. _error is set before.
+		std::atomic<bool> _available{ true };
+		std::string _error;
+		std::atomic<bool> _running{ false };
+		std::thread _scanner;
+		std::atomic<int> _scannerTid{ -1 };
+		std::mutex _mutex;
+		std::vector<ThreadCounters> _threads;
+	};
+}
@@ -0,0 +1,132 @@
+#include "Process.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+std::uint64_t StressTool::Process::residentMemory(int pid)
+{
+#if defined(WIN32) || defined(_WIN32)
+	auto process = pid == 0 ? GetCurrentProcess() : OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+	if (!process)
+	{
+		return 0;
+	}
+	PROCESS_MEMORY_COUNTERS counters;
+	auto succeeded = GetProcessMemoryInfo(process, &counters, sizeof(counters));
+	if (pid != 0)
+	{
+		CloseHandle(process);
+	}
+	return succeeded ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+	//statm contains sizes in pages: total, resident, shared...
+	std::ifstream statm(pid == 0 ? std::string("/proc/self/statm") : "/proc/" + std::to_string(pid) + "/statm");
+	std::uint64_t size = 0;
+	std::uint64_t resident = 0;
+	if (statm >> size >> resident)
+	{
+		return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	}
+	return 0;
+#else
+	return 0;
+#endif
+}
+
+double StressTool::Process::cpuTime()
+{
+#if defined(WIN32) || defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		auto ticks = [](const FILETIME& time) {
+			return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+		};
+		//FILETIME counts 100ns intervals.
+		return (ticks(kernel) + ticks(user)) / 1e7;
+	}
+	return 0;
+#elif defined(__linux__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	}
+	return 0;
+#else
+	return 0;
+#endif
+}
+
+int StressTool::Process::threadCount()
+{
+#if defined(__linux__)
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 8, "Threads:") == 0)
+		{
+			return std::stoi(line.substr(8));
+		}
+	}
+	return 0;
+#elif defined(WIN32) || defined(_WIN32)
+	auto snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+	if (snapshot == INVALID_HANDLE_VALUE)
+	{
+		return 0;
+	}
+	int count = 0;
+	THREADENTRY32 entry;
+	entry.dwSize = sizeof(entry);
+	for (auto found = Thread32First(snapshot, &entry); found; found = Thread32Next(snapshot, &entry))
+	{
+		if (entry.th32OwnerProcessID == GetCurrentProcessId())
+		{
+			count++;
+		}
+	}
+	CloseHandle(snapshot);
+	return count;
+#else
+	return 0;
+#endif
+}
+
+int StressTool::Process::openHandles()
+{
+#if defined(WIN32) || defined(_WIN32)
+	DWORD count = 0;
+	return GetProcessHandleCount(GetCurrentProcess(), &count) ? static_cast<int>(count) : 0;
+#elif defined(__linux__)
+	auto dir = opendir("/proc/self/fd");
+	if (!dir)
+	{
+		return 0;
+	}
+	int count = 0;
+	while (auto entry = readdir(dir))
+	{
+		if (entry->d_name[0] != '.')
+		{
+			count++;
+		}
+	}
+	closedir(dir);
+	//Don't count the descriptor used to read the directory.
+	return count - 1;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+namespace StressTool
+{
+	namespace Process
+	{
+		/// <summary>
+		/// Resident set size in bytes of the process <c>pid</c>, or of the current process if <c>pid</c> is 0.
+		/// </summary>
+		/// <returns>0 if it isn't available on this platform, or if the process can't be read.</returns>
+		std::uint64_t residentMemory(int pid = 0);
+
+		/// <summary>
+		/// Number of threads of the current process, or 0 if it isn't available.
+		/// </summary>
+		int threadCount();
+
+		/// <summary>
+		/// Number of open file descriptors (handles on Windows) of the current process, or 0 if it isn't available on this platform.
+		/// </summary>
+		int openHandles();
+
+		/// <summary>
+		/// User and kernel CPU time consumed by all threads of the process since its start, in seconds.
+		/// </summary>
+		double cpuTime();
+	}
+}
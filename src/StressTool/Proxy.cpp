@@ -0,0 +1,57 @@
+#include "Benchmarks.h"
+#include "NetworkProxy.h"
+#include "Timer.h"
+#include <iostream>
+#include <thread>
+
+int StressTool::runProxy(const Options& options)
+{
+	Impairment impairment;
+	auto profile = options.getString("profile", "mobile4g");
+	if (!Impairment::profile(profile, impairment))
+	{
+		std::cout << "unknown profile '" << profile << "'. Available profiles:\n";
+		for (auto& name : Impairment::profiles())
+		{
+			std::cout << "  " << name << "\n";
+		}
+		return 2;
+	}
+	//Options override the values of the profile.
+	impairment.latency = options.getDouble("latency", impairment.latency);
+	impairment.jitter = options.getDouble("jitter", impairment.jitter);
+	impairment.latencySpread = options.getDouble("latencySpread", impairment.latencySpread);
+	impairment.loss = options.getDouble("loss", impairment.loss);
+	impairment.reorder = options.getDouble("reorder", impairment.reorder);
+	impairment.bandwidth = options.getDouble("bandwidth", impairment.bandwidth);
+
+	auto udpListen = options.getInt("udpListen", 30110);
+	auto udpTarget = options.getInt("udpTarget", 30100);
+	auto tcpListen = options.getInt("tcpListen", 80);
+	auto tcpTarget = options.getInt("tcpTarget", 8081);
+	//0 runs until the process is stopped.
+	auto duration = options.getDouble("duration", 0);
+	auto reportInterval = options.getInt("report", 10);
+
+	NetworkProxy proxy(impairment, options.getString("target", "127.0.0.1"));
+	if (!proxy.startUdp(udpListen, udpTarget) || !proxy.startTcp(tcpListen, tcpTarget))
+	{
+		std::cout << "failed to start the proxy : " << proxy.error() << "\n";
+		return 2;
+	}
+
+	std::cout << "proxy profile " << profile << " : latency " << impairment.latency << "ms (+/-" << impairment.latencySpread * 100 << "% per client), jitter " << impairment.jitter
+		<< "ms, loss " << impairment.loss * 100 << "%, reorder " << impairment.reorder * 100 << "%, bandwidth " << (impairment.bandwidth > 0 ? std::to_string(static_cast<int>(impairment.bandwidth)) + "kbit/s" : "unlimited") << "\n";
+	std::cout << "udp " << udpListen << " -> " << udpTarget << ", tcp " << tcpListen << " -> " << tcpTarget << "\n";
+
+	Timer timer;
+	timer.start();
+	while (duration <= 0 || timer.getElapsedTimeInSec() < duration)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(reportInterval));
+		auto& counters = proxy.counters();
+		std::cout << "flows=" << counters.flows << " forwarded=" << counters.forwarded << " (" << counters.bytes / 1024 << "KB) dropped=" << counters.dropped << " reordered=" << counters.reordered << "\n";
+	}
+	proxy.stop();
+	return 0;
+}
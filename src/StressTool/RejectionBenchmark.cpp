@@ -0,0 +1,175 @@
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "Process.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	constexpr const char* NotifyingScene = "test-connection-rejected";
+
+	struct Attempt
+	{
+		//Success means rejected with the expected reason.
+		StressTool::Result result;
+		bool accepted = false;
+		//The client failed to log in and never tried to connect: result holds no duration.
+		bool loginFailed = false;
+	};
+
+	pplx::task<Attempt> connect(int id, std::string sceneId, bool login, std::string reason)
+	{
+		auto timer = std::make_shared<Timer>();
+		//Set when the connection starts, to tell a login failure from a connection failure.
+		auto connecting = std::make_shared<bool>(false);
+		auto ready = login ? StressTool::Clients::login(id) : pplx::task_from_result(Stormancer::IClientFactory::GetClient(id));
+		return ready.then([timer, connecting, sceneId](std::shared_ptr<Stormancer::IClient> client) {
+			*connecting = true;
+			timer->start();
+			return client->connectToPublicScene(sceneId);
+		})
+		.then([id, timer, connecting, reason](pplx::task<std::shared_ptr<Stormancer::Scene>> t) {
+			Attempt attempt;
+			try
+			{
+				t.get();
+				attempt.accepted = true;
+				attempt.result.success = false;
+			}
+			catch (std::exception& ex)
+			{
+				attempt.loginFailed = !*connecting;
+				attempt.result.success = !attempt.loginFailed && std::string(ex.what()).find(reason) != std::string::npos;
+				if (!attempt.result.success)
+				{
+					std::cout << ex.what() << "\n";
+				}
+			}
+			if (*connecting)
+			{
+				attempt.result.duration = timer->getElapsedTimeInMilliSec();
+			}
+			Stormancer::IClientFactory::ReleaseClient(id);
+			return attempt;
+		});
+	}
+}
+
+int StressTool::runRejectionBenchmark(const Options& options)
+{
+	auto sceneId = options.getString("scene", "rejection-test-scene");
+	auto notifying = sceneId == NotifyingScene;
+	auto reason = options.getString("reason", notifying ? "Rejected" : "reject");
+	auto login = options.getBool("login", false);
+	auto rate = options.getDouble("startRate", 50);
+	auto maxRate = options.getDouble("maxRate", 2000);
+	auto stepDuration = options.getDouble("stepDuration", 10);
+	//Pid of a server running on the same host, to follow its memory.
+	auto serverPid = options.getInt("serverPid", 0);
+
+	ConfigurationTemplate(login).install();
+
+	//test-connection-rejected accepts a single peer, and notifies it of every rejection.
+	auto notifications = std::make_shared<std::atomic<std::uint64_t>>(0);
+	if (notifying)
+	{
+		auto holder = login ? Clients::login(0).get() : Stormancer::IClientFactory::GetClient(0);
+		holder->connectToPublicScene(sceneId, [notifications](std::shared_ptr<Stormancer::Scene> scene) {
+			scene->addRoute("connectionRejected", [notifications](Stormancer::Packetisp_ptr) {
+				(*notifications)++;
+			});
+		}).get();
+	}
+
+	auto clientMemoryBefore = Process::residentMemory();
+	auto threadsBefore = Process::threadCount();
+	auto serverMemoryBefore = serverPid ? Process::residentMemory(serverPid) : 0;
+	std::uint64_t totalRejections = 0;
+
+	std::cout << "rejection benchmark on " << sceneId << (login ? " with login" : "") << "\n";
+	std::cout << std::setw(10) << "offered/s" << std::setw(12) << "rejected/s" << std::setw(10) << "p50(ms)" << std::setw(10) << "p99(ms)"
+		<< std::setw(10) << "accepted" << std::setw(10) << "errors" << std::setw(14) << "login errors" << std::setw(14) << "client RSS KB" << std::setw(10) << "threads";
+	if (serverPid)
+	{
+		std::cout << std::setw(14) << "server RSS KB";
+	}
+	std::cout << "\n";
+
+	int nextId = 1;
+	for (; rate <= maxRate; rate *= 2)
+	{
+		std::vector<pplx::task<Attempt>> tasks;
+		Pacer pacer(rate);
+		Timer timer;
+		timer.start();
+		while (timer.getElapsedTimeInSec() < stepDuration)
+		{
+			pacer.wait();
+			tasks.push_back(connect(nextId++, sceneId, login, reason));
+		}
+		auto attempts = pplx::when_all(tasks.begin(), tasks.end()).get();
+		timer.stop();
+
+		std::vector<Result> results;
+		std::size_t accepted = 0;
+		std::size_t loginErrors = 0;
+		for (auto& attempt : attempts)
+		{
+			if (attempt.loginFailed)
+			{
+				loginErrors++;
+				continue;
+			}
+			results.push_back(attempt.result);
+			if (attempt.accepted)
+			{
+				accepted++;
+			}
+		}
+		auto s = stats(results);
+		auto rejected = static_cast<std::size_t>(s.successRate * s.count + 0.5);
+		totalRejections += rejected;
+		addCompletedOperations(rejected);
+		RunReport::record("rejection." + std::to_string(static_cast<int>(rate)), results);
+		RunReport::setCounter("rejection." + std::to_string(static_cast<int>(rate)) + ".perSecond", rejected / timer.getElapsedTimeInSec());
+
+		std::cout << std::setw(10) << rate << std::setw(12) << rejected / timer.getElapsedTimeInSec() << std::setw(10) << s.p50 << std::setw(10) << s.p99
+			<< std::setw(10) << accepted << std::setw(10) << s.count - rejected - accepted << std::setw(14) << loginErrors
+			<< std::setw(14) << Process::residentMemory() / 1024 << std::setw(10) << Process::threadCount();
+		if (serverPid)
+		{
+			std::cout << std::setw(14) << Process::residentMemory(serverPid) / 1024;
+		}
+		std::cout << "\n";
+	}
+
+	//Every client is released after its rejection: memory and threads growing with the number of rejections point to a leak.
+	auto clientGrowth = static_cast<double>(Process::residentMemory()) - static_cast<double>(clientMemoryBefore);
+	RunReport::setCounter("rejection.total", static_cast<double>(totalRejections));
+	if (totalRejections > 0)
+	{
+		std::cout << "client RSS growth  : " << clientGrowth / totalRejections * 1000 / 1024 << " KB per 1000 rejections\n";
+		RunReport::setCounter("rejection.clientBytesPerRejection", clientGrowth / totalRejections);
+		if (serverPid)
+		{
+			auto serverGrowth = static_cast<double>(Process::residentMemory(serverPid)) - static_cast<double>(serverMemoryBefore);
+			std::cout << "server RSS growth  : " << serverGrowth / totalRejections * 1000 / 1024 << " KB per 1000 rejections\n";
+			RunReport::setCounter("rejection.serverBytesPerRejection", serverGrowth / totalRejections);
+		}
+	}
+	std::cout << "client threads     : " << threadsBefore << " -> " << Process::threadCount() << "\n";
+	if (notifying)
+	{
+		//The holder is notified from the server ConnectionRejected event, once per rejected peer.
+		std::cout << "server notified    : " << *notifications << " of " << totalRejections << " rejections\n";
+		RunReport::setCounter("rejection.serverNotifications", static_cast<double>(*notifications));
+		Stormancer::IClientFactory::ReleaseClient(0);
+	}
+	return 0;
+}
@@ -0,0 +1,170 @@
+#define NOMINMAX
+#include "RunReport.h"
+#include "Stats.h"
+#include "stormancer/cpprestsdk/cpprest/json.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	namespace json = Stormancer::web::json;
+	namespace conversions = Stormancer::utility::conversions;
+
+	std::mutex reportMutex;
+	std::map<std::string, std::vector<StressTool::Result>> metrics;
+	std::map<std::string, double> counters;
+
+	std::string environmentVariable(const char* name)
+	{
+		auto value = std::getenv(name);
+		return value ? value : "";
+	}
+
+	json::value environment()
+	{
+		auto env = json::value::object();
+#if defined(WIN32) || defined(_WIN32)
+		env[U("os")] = json::value::string(U("windows"));
+		env[U("host")] = json::value::string(conversions::to_string_t(environmentVariable("COMPUTERNAME")));
+#else
+		env[U("os")] = json::value::string(U("linux"));
+		env[U("host")] = json::value::string(conversions::to_string_t(environmentVariable("HOSTNAME")));
+#endif
+		env[U("hardwareConcurrency")] = json::value::number(static_cast<int>(std::thread::hardware_concurrency()));
+
+		char timestamp[32];
+		auto now = std::time(nullptr);
+		std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+		env[U("timestamp")] = json::value::string(conversions::to_string_t(std::string(timestamp)));
+		return env;
+	}
+
+	//Log scale histogram, 4 buckets per power of two, from 1/8ms to ~65s.
+	json::value histogram(const std::vector<double>& sortedDurations)
+	{
+		auto result = json::value::array();
+		std::size_t index = 0;
+		std::size_t bucket = 0;
+		for (auto upperBound = 0.125; upperBound < 70000 && index < sortedDurations.size(); upperBound *= std::pow(2.0, 0.25))
+		{
+			std::size_t count = 0;
+			while (index < sortedDurations.size() && sortedDurations[index] <= upperBound)
+			{
+				count++;
+				index++;
+			}
+			if (count > 0)
+			{
+				auto entry = json::value::array(2);
+				entry[0] = json::value::number(upperBound);
+				entry[1] = json::value::number(static_cast<double>(count));
+				result[bucket++] = entry;
+			}
+		}
+		if (index < sortedDurations.size())
+		{
+			auto entry = json::value::array(2);
+			entry[0] = json::value::string(U("inf"));
+			entry[1] = json::value::number(static_cast<double>(sortedDurations.size() - index));
+			result[bucket++] = entry;
+		}
+		return result;
+	}
+
+	json::value metric(const std::vector<StressTool::Result>& results)
+	{
+		auto s = StressTool::stats(results);
+		std::vector<double> durations;
+		for (auto& r : results)
+		{
+			if (r.success)
+			{
+				durations.push_back(r.duration);
+			}
+		}
+		std::sort(durations.begin(), durations.end());
+
+		auto m = json::value::object();
+		m[U("count")] = json::value::number(static_cast<double>(results.size()));
+		m[U("successRate")] = json::value::number(s.successRate);
+		m[U("avg")] = json::value::number(s.avg);
+		m[U("min")] = json::value::number(s.min);
+		m[U("p50")] = json::value::number(s.p50);
+		m[U("p90")] = json::value::number(s.p90);
+		m[U("p99")] = json::value::number(s.p99);
+		m[U("p999")] = json::value::number(s.p999);
+		m[U("max")] = json::value::number(s.max);
+		m[U("histogram")] = histogram(durations);
+
+		//Keep samples in run order so that a downsampled set still covers the whole run.
+		auto samples = json::value::array();
+		std::size_t successes = durations.size();
+		auto stride = std::max<std::size_t>(1, (successes + StressTool::RunReport::MaxSamples - 1) / StressTool::RunReport::MaxSamples);
+		std::size_t successIndex = 0;
+		std::size_t sampleIndex = 0;
+		for (auto& r : results)
+		{
+			if (r.success && successIndex++ % stride == 0)
+			{
+				samples[sampleIndex++] = json::value::number(r.duration);
+			}
+		}
+		m[U("samples")] = samples;
+		return m;
+	}
+}
+
+void StressTool::RunReport::record(const std::string& name, const std::vector<Result>& results)
+{
+	std::lock_guard<std::mutex> lg(reportMutex);
+	auto& values = metrics[name];
+	values.insert(values.end(), results.begin(), results.end());
+}
+
+void StressTool::RunReport::setCounter(const std::string& name, double value)
+{
+	std::lock_guard<std::mutex> lg(reportMutex);
+	counters[name] = value;
+}
+
+bool StressTool::RunReport::save(const std::string& path, const Options& options)
+{
+	std::lock_guard<std::mutex> lg(reportMutex);
+
+	auto report = json::value::object();
+	report[U("version")] = json::value::number(1);
+	report[U("mode")] = json::value::string(conversions::to_string_t(options.mode()));
+
+	auto config = json::value::object();
+	for (auto& option : options.values())
+	{
+		config[conversions::to_string_t(option.first)] = json::value::string(conversions::to_string_t(option.second));
+	}
+	report[U("options")] = config;
+	report[U("environment")] = environment();
+
+	auto countersJson = json::value::object();
+	countersJson[U("completedOperations")] = json::value::number(static_cast<double>(completedOperations()));
+	for (auto& counter : counters)
+	{
+		countersJson[conversions::to_string_t(counter.first)] = json::value::number(counter.second);
+	}
+	report[U("counters")] = countersJson;
+
+	auto metricsJson = json::value::object();
+	for (auto& m : metrics)
+	{
+		metricsJson[conversions::to_string_t(m.first)] = metric(m.second);
+	}
+	report[U("metrics")] = metricsJson;
+
+	std::ofstream file(path, std::ios::binary);
+	file << conversions::to_utf8string(report.serialize());
+	return file.good();
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Options.h"
+#include "Worker.h"
+
+namespace StressTool
+{
+	/// <summary>
+	/// Machine readable results of a run, saved as JSON with --output=path and compared by the "compare" mode.
+	/// </summary>
+	/// <remarks>
+	/// Contains the options, the environment, and for each metric recorded by the benchmark the latency statistics, a histogram and the latency samples.
+	/// Samples are downsampled to at most MaxSamples per metric.
+	/// </remarks>
+	namespace RunReport
+	{
+		constexpr std::size_t MaxSamples = 20000;
+
+		/// <summary>
+		/// Records the results of a measured operation. Results recorded several times under the same name are merged.
+		/// </summary>
+		void record(const std::string& metric, const std::vector<Result>& results);
+
+		/// <summary>
+		/// Records a scalar value (rate, ratio...).
+		/// </summary>
+		void setCounter(const std::string& name, double value);
+
+		/// <summary>
+		/// Saves the report of the run to a JSON file.
+		/// </summary>
+		/// <returns>False if the file couldn't be written.</returns>
+		bool save(const std::string& path, const Options& options);
+	}
+}
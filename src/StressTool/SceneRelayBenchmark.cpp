@@ -0,0 +1,167 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "stormancer/Serializer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	constexpr const char* SceneId = "relay-bench";
+
+	struct ReplicaState
+	{
+		std::atomic<std::uint64_t> updatesReceived{ 0 };
+		std::mutex latenciesMutex;
+		std::vector<StressTool::Result> latencies;
+	};
+
+	std::int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	pplx::task<std::shared_ptr<Stormancer::Scene>> joinSession(int id, std::shared_ptr<ReplicaState> state)
+	{
+		return StressTool::Clients::login(id).then([state](std::shared_ptr<Stormancer::IClient> client) {
+			//Routes must be declared before the scene is connected.
+			return client->connectToPublicScene(SceneId, [state](std::shared_ptr<Stormancer::Scene> scene) {
+				scene->addRoute("relay.update", [state](Stormancer::Packetisp_ptr packet) {
+					Stormancer::Serializer serializer;
+					int owner;
+					int entity;
+					std::int64_t sentOn;
+					std::string component;
+					serializer.deserialize(packet->stream, owner, entity, sentOn, component);
+
+					StressTool::Result r;
+					r.success = true;
+					r.duration = (now() - sentOn) * 0.000001;
+
+					state->updatesReceived++;
+					std::lock_guard<std::mutex> lg(state->latenciesMutex);
+					state->latencies.push_back(r);
+				});
+			});
+		});
+	}
+}
+
+int StressTool::runSceneRelayBenchmark(const Options& options)
+{
+	auto nbClients = options.getInt("clients", 8);
+	auto nbEntities = options.getInt("entities", 4);
+	auto tickRate = options.getDouble("tick", 20);
+	auto componentSize = options.getInt("componentSize", 32);
+	auto duration = options.getDouble("duration", 30);
+
+	ConfigurationTemplate().install();
+	std::vector<std::shared_ptr<ReplicaState>> states;
+	std::vector<pplx::task<std::shared_ptr<Stormancer::Scene>>> joins;
+	for (int i = 0; i < nbClients; i++)
+	{
+		auto state = std::make_shared<ReplicaState>();
+		states.push_back(state);
+		joins.push_back(joinSession(i, state));
+	}
+	auto scenes = Clients::waitConnections(joins);
+	//Only the clients that joined send updates and are expected to receive them.
+	std::vector<int> owners;
+	for (int i = 0; i < nbClients; i++)
+	{
+		if (scenes[i])
+		{
+			owners.push_back(i);
+		}
+	}
+	std::cout << "connected " << owners.size() << "/" << nbClients << " clients\n";
+	if (owners.empty())
+	{
+		for (int i = 0; i < nbClients; i++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(i);
+		}
+		return 1;
+	}
+
+	//Every update carries a component of componentSize bytes. Only the size matters, not the content.
+	std::string component(componentSize, 'x');
+	std::uint64_t updatesSent = 0;
+	std::size_t bytesPerUpdate = 0;
+
+	Pacer pacer(tickRate);
+	Timer timer;
+	timer.start();
+	while (timer.getElapsedTimeInSec() < duration)
+	{
+		pacer.wait();
+		for (auto owner : owners)
+		{
+			for (int entity = 0; entity < nbEntities; entity++)
+			{
+				Stormancer::Serializer serializer;
+				Stormancer::obytestream stream;
+				serializer.serialize(stream, owner, entity, now(), component);
+				auto bytes = stream.bytes();
+				bytesPerUpdate = bytes.size();
+
+				scenes[owner]->send(Stormancer::PeerFilter::matchSceneHost(), "SceneRelay.Update", [bytes](Stormancer::obytestream& s) {
+					s.write(bytes.data(), bytes.size());
+				}, Stormancer::PacketPriority::MEDIUM_PRIORITY, Stormancer::PacketReliability::UNRELIABLE);
+				updatesSent++;
+			}
+		}
+	}
+	//Let in flight updates arrive before collecting results.
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	timer.stop();
+
+	for (int i = 0; i < nbClients; i++)
+	{
+		Stormancer::IClientFactory::ReleaseClient(i);
+	}
+
+	std::vector<Result> latencies;
+	std::uint64_t updatesReceived = 0;
+	std::uint64_t minUpdatesReceived = std::numeric_limits<std::uint64_t>::max();
+	for (auto owner : owners)
+	{
+		auto& state = states[owner];
+		std::lock_guard<std::mutex> lg(state->latenciesMutex);
+		latencies.insert(latencies.end(), state->latencies.begin(), state->latencies.end());
+		updatesReceived += state->updatesReceived;
+		minUpdatesReceived = std::min<std::uint64_t>(minUpdatesReceived, state->updatesReceived);
+	}
+
+	addCompletedOperations(updatesSent);
+
+	auto elapsed = timer.getElapsedTimeInSec();
+	auto connected = static_cast<double>(owners.size());
+	//Each update is broadcast to every client of the scene, including its owner.
+	auto expected = static_cast<double>(updatesSent) * connected;
+
+	RunReport::record("relay.latency", latencies);
+	RunReport::setCounter("relay.payloadBytesPerUpdate", static_cast<double>(bytesPerUpdate));
+	RunReport::setCounter("relay.deliveryRatio", expected > 0 ? updatesReceived / expected : 0);
+	RunReport::setCounter("relay.updatesPerSecondPerClient", updatesReceived / elapsed / connected);
+
+	std::cout << "scene relay benchmark : " << owners.size() << " clients, " << nbEntities << " entities/client, " << tickRate << " ticks/s\n";
+	std::cout << "payload per update    : " << bytesPerUpdate << "B (component " << componentSize << "B, without protocol overhead)\n";
+	std::cout << "updates sent          : " << updatesSent << "\n";
+	std::cout << "delivery ratio        : " << (expected > 0 ? updatesReceived / expected * 100 : 0) << "%\n";
+	std::cout << "updates/s per client  : avg " << updatesReceived / elapsed / connected << ", min " << minUpdatesReceived / elapsed << "\n";
+	std::cout << "payload per client    : " << updatesReceived * bytesPerUpdate / elapsed / connected / 1024 << "KB/s\n";
+	std::cout << "relay latency\n";
+	print(std::cout, stats(latencies));
+	return 0;
+}
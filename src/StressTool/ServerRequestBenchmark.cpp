@@ -0,0 +1,229 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Pacer.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include "stormancer/RPC/Service.h"
+//Provides APIs related to authentication & user management.
+#include "Users/Users.hpp"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	//Server RPCs of UsersTestController sending a request to the calling user, and the operation they send.
+	struct Route
+	{
+		const char* operation;
+		const char* rpc;
+	};
+
+	const Route routes[] = {
+		{ "a", "UsersTest.TestSendRequest" },
+		{ "b", "UsersTest.TestSendRequestGeneric" },
+		{ "c", "UsersTest.TestSendRequestGeneric2" }
+	};
+
+	struct RouteResults
+	{
+		std::vector<StressTool::Result> roundTrips;
+		//From the RPC call to the client handler, and from the handler to the RPC completion. Only for b and c, which carry the id of the call.
+		std::vector<StressTool::Result> outbound;
+		std::vector<StressTool::Result> inbound;
+		int handled = 0;
+	};
+
+	struct RequestState
+	{
+		std::mutex mutex;
+		std::unordered_map<std::string, RouteResults> results;
+		//Time at which the handler received each call, by call id.
+		std::unordered_map<std::string, Clock::time_point> handledAt;
+
+		void onRequest(const std::string& operation, const std::string& callId)
+		{
+			std::lock_guard<std::mutex> lg(mutex);
+			results[operation].handled++;
+			if (!callId.empty())
+			{
+				handledAt[callId] = Clock::now();
+			}
+		}
+	};
+
+	void setHandlers(std::shared_ptr<Stormancer::IClient> client, std::shared_ptr<RequestState> state)
+	{
+		auto users = client->dependencyResolver().resolve<Stormancer::Users::UsersApi>();
+		users->setOperationHandler("a", [state](Stormancer::Users::OperationCtx& ctx) {
+			state->onRequest(ctx.operation, "");
+			return pplx::task_from_result();
+		});
+		users->setOperationHandler("b", [state](Stormancer::Users::OperationCtx& ctx) {
+			state->onRequest(ctx.operation, ctx.request->readObject<std::string>());
+			ctx.request->sendValueTemplated(true);
+			return pplx::task_from_result();
+		});
+		users->setOperationHandler("c", [state](Stormancer::Users::OperationCtx& ctx) {
+			state->onRequest(ctx.operation, ctx.request->readObject<std::string>());
+			return pplx::task_from_result();
+		});
+	}
+
+	pplx::task<void> call(std::shared_ptr<Stormancer::RpcService> rpc, const Route& route, const std::string& callId)
+	{
+		if (std::string(route.operation) == "a")
+		{
+			return rpc->rpc<void>(route.rpc);
+		}
+		else if (std::string(route.operation) == "b")
+		{
+			return rpc->rpc<bool>(route.rpc, callId).then([](bool) {});
+		}
+		else
+		{
+			return rpc->rpc<void>(route.rpc, callId);
+		}
+	}
+
+	double milliseconds(Clock::duration d)
+	{
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+}
+
+int StressTool::runServerRequestBenchmark(const Options& options)
+{
+	auto clients = options.getInt("clients", 10);
+	auto rate = options.getDouble("rate", 100);
+	auto duration = options.getDouble("duration", 30);
+	//a, b, c, or all to alternate between the three.
+	auto routeOption = options.getString("route", "all");
+
+	std::vector<Route> selected;
+	for (auto& route : routes)
+	{
+		if (routeOption == "all" || routeOption == route.operation)
+		{
+			selected.push_back(route);
+		}
+	}
+	if (selected.empty())
+	{
+		std::cout << "unknown route '" << routeOption << "', expected a, b, c or all\n";
+		return 1;
+	}
+
+	ConfigurationTemplate().install();
+
+	auto state = std::make_shared<RequestState>();
+	std::vector<pplx::task<std::shared_ptr<Stormancer::RpcService>>> connections;
+	for (int id = 0; id < clients; id++)
+	{
+		//Handlers are set before login, the server only sends requests to authenticated users.
+		setHandlers(Stormancer::IClientFactory::GetClient(id), state);
+		connections.push_back(Clients::login(id).then([](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene("test-scene");
+		})
+		.then([](std::shared_ptr<Stormancer::Scene> scene) {
+			return scene->dependencyResolver().resolve<Stormancer::RpcService>();
+		}));
+	}
+	std::vector<std::shared_ptr<Stormancer::RpcService>> rpcs;
+	try
+	{
+		rpcs = pplx::when_all(connections.begin(), connections.end()).get();
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "failed to connect the clients: " << ex.what() << "\n";
+		for (int id = 0; id < clients; id++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(id);
+		}
+		return 1;
+	}
+
+	std::cout << "server to client requests: " << clients << " clients, " << rate << " calls/s for " << duration << "s, route " << routeOption << "\n";
+	std::vector<pplx::task<void>> calls;
+	Pacer pacer(rate);
+	Timer timer;
+	timer.start();
+	for (std::size_t i = 0; timer.getElapsedTimeInSec() < duration; i++)
+	{
+		pacer.wait();
+		auto& route = selected[i % selected.size()];
+		auto callId = std::to_string(i);
+		auto operation = std::string(route.operation);
+		auto start = Clock::now();
+		calls.push_back(call(rpcs[i % rpcs.size()], route, callId).then([state, operation, callId, start](pplx::task<void> t) {
+			auto end = Clock::now();
+			Result r;
+			r.duration = milliseconds(end - start);
+			try
+			{
+				t.get();
+				r.success = true;
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				r.success = false;
+			}
+
+			std::lock_guard<std::mutex> lg(state->mutex);
+			auto& results = state->results[operation];
+			results.roundTrips.push_back(r);
+			auto handled = state->handledAt.find(callId);
+			if (handled != state->handledAt.end())
+			{
+				Result outbound;
+				outbound.success = r.success;
+				outbound.duration = milliseconds(handled->second - start);
+				results.outbound.push_back(outbound);
+				Result inbound;
+				inbound.success = r.success;
+				inbound.duration = milliseconds(end - handled->second);
+				results.inbound.push_back(inbound);
+				state->handledAt.erase(handled);
+			}
+		}));
+	}
+	pplx::when_all(calls.begin(), calls.end()).wait();
+	auto elapsed = timer.getElapsedTimeInSec();
+
+	for (int id = 0; id < clients; id++)
+	{
+		Stormancer::IClientFactory::ReleaseClient(id);
+	}
+
+	std::lock_guard<std::mutex> lg(state->mutex);
+	for (auto& route : selected)
+	{
+		auto& results = state->results[route.operation];
+		auto s = stats(results.roundTrips);
+		addCompletedOperations(static_cast<std::uint64_t>(s.count));
+		auto name = std::string("serverRequest.") + route.operation;
+		RunReport::record(name, results.roundTrips);
+		RunReport::setCounter(name + ".callsPerSecond", s.count / elapsed);
+		std::cout << route.operation << " (" << route.rpc << ") n=" << results.roundTrips.size() << " handled=" << results.handled
+			<< " success=" << s.successRate * 100 << "% " << s.count / elapsed << "/s\n";
+		std::cout << "  round trip      p50=" << s.p50 << "ms p90=" << s.p90 << "ms p99=" << s.p99 << "ms max=" << s.max << "ms\n";
+		if (!results.outbound.empty())
+		{
+			RunReport::record(name + ".outbound", results.outbound);
+			RunReport::record(name + ".inbound", results.inbound);
+			auto outbound = stats(results.outbound);
+			auto inbound = stats(results.inbound);
+			std::cout << "  call->handler   p50=" << outbound.p50 << "ms p99=" << outbound.p99 << "ms\n";
+			std::cout << "  handler->result p50=" << inbound.p50 << "ms p99=" << inbound.p99 << "ms\n";
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,181 @@
+#define NOMINMAX
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Process.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "TestDto.h"
+#include "Timer.h"
+#include "stormancer/RPC/Service.h"
+#include "stormancer/Serializer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	struct StreamState
+	{
+		std::atomic<std::uint64_t> received{ 0 };
+		std::atomic<std::uint64_t> bytes{ 0 };
+		std::atomic<bool> done{ false };
+		std::atomic<bool> failed{ false };
+	};
+
+	struct StreamResult
+	{
+		std::uint64_t received = 0;
+		double elapsed = 0;
+		bool failed = false;
+		//Server resident memory when the stream started, and its peak during the stream, in bytes.
+		double serverStart = 0;
+		double serverPeak = 0;
+	};
+
+	//Reads the merged stream with a server buffer of capacity items, printing a row every sampleInterval seconds.
+	StreamResult readStream(std::shared_ptr<Stormancer::RpcService> rpc, int count, int size, int capacity, const std::string& adminKey, int itemDelay, int serverPid, double sampleInterval)
+	{
+		std::cout << "server buffer " << (capacity > 0 ? std::to_string(capacity) : "unbounded") << "\n";
+		std::cout << std::setw(8) << "time(s)" << std::setw(12) << "received" << std::setw(12) << "items/s" << std::setw(16) << "server RSS(KB)" << "\n";
+
+		StreamResult result;
+		result.serverStart = serverPid != 0 ? static_cast<double>(StressTool::Process::residentMemory(serverPid)) : 0;
+		result.serverPeak = result.serverStart;
+		auto state = std::make_shared<StreamState>();
+		Timer timer;
+		timer.start();
+		auto subscription = rpc->rpcObservable("Test.TestS2SStream", [count, size, capacity, adminKey](Stormancer::obytestream& stream) {
+			Stormancer::Serializer serializer;
+			serializer.serialize(stream, count, size, capacity, adminKey);
+		}).subscribe([state, itemDelay](Stormancer::Packetisp_ptr packet) {
+			Stormancer::Serializer serializer;
+			StressTool::TestDto item;
+			serializer.deserialize(packet->stream, item);
+			state->received++;
+			state->bytes += item.value.size();
+			//Blocks the thread delivering items, so that the client reads from the network at the speed it processes items.
+			std::this_thread::sleep_for(std::chrono::milliseconds(itemDelay));
+		}, [state](std::exception_ptr ex) {
+			try
+			{
+				std::rethrow_exception(ex);
+			}
+			catch (std::exception& e)
+			{
+				std::cout << e.what() << "\n";
+			}
+			state->failed = true;
+			state->done = true;
+		}, [state]() {
+			state->done = true;
+		});
+
+		std::uint64_t lastReceived = 0;
+		while (!state->done)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(sampleInterval));
+			auto elapsed = timer.getElapsedTimeInSec();
+			auto received = state->received.load();
+			auto memory = serverPid != 0 ? static_cast<double>(StressTool::Process::residentMemory(serverPid)) : 0;
+			result.serverPeak = std::max(result.serverPeak, memory);
+			std::cout << std::setw(8) << static_cast<int>(elapsed) << std::setw(12) << received << std::setw(12) << (received - lastReceived) / sampleInterval
+				<< std::setw(16) << memory / 1024 << "\n";
+			lastReceived = received;
+		}
+		result.elapsed = timer.getElapsedTimeInSec();
+		subscription.unsubscribe();
+		result.received = state->received.load();
+		result.failed = state->failed;
+		std::cout << "received " << result.received << " items (" << state->bytes / 1024 << "KB) in " << result.elapsed << "s, " << result.received / result.elapsed << " items/s"
+			<< (result.failed ? ", stream failed" : "") << "\n";
+		return result;
+	}
+}
+
+int StressTool::runSlowConsumerBenchmark(const Options& options)
+{
+	//Items produced by each of the TestPlugin::S2S_SCENE_COUNT S2S scenes.
+	auto count = options.getInt("count", 2000);
+	auto size = options.getInt("size", 1024);
+	//Merge buffer on the server compared with an unbounded one, 0 to only run the unbounded merge.
+	auto capacity = options.getInt("capacity", 64);
+	//Processing time of each item by the client.
+	auto itemDelay = options.getInt("itemDelay", 2);
+	auto serverPid = options.getInt("serverPid", 0);
+	auto sampleInterval = options.getDouble("sampleInterval", 1);
+	//Must match stressTool.adminKey in the application configuration, which enables the unbounded merge.
+	auto adminKey = options.getString("adminKey", "");
+
+	//The bounded merge runs first: the server may keep the memory grown by the unbounded one, which would hide the growth of a later run.
+	std::vector<int> capacities;
+	if (capacity > 0)
+	{
+		capacities.push_back(capacity);
+	}
+	if (!adminKey.empty())
+	{
+		capacities.push_back(0);
+	}
+	else
+	{
+		std::cout << "set --adminKey to compare with the unbounded merge\n";
+	}
+	if (capacities.empty())
+	{
+		std::cout << "--capacity=0 requires --adminKey\n";
+		return 1;
+	}
+
+	ConfigurationTemplate().install();
+	std::shared_ptr<Stormancer::RpcService> rpc;
+	try
+	{
+		auto scene = Clients::login(0).then([](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene("test-scene");
+		}).get();
+		rpc = scene->dependencyResolver().resolve<Stormancer::RpcService>();
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "failed to connect: " << ex.what() << "\n";
+		Stormancer::IClientFactory::ReleaseClient(0);
+		return 1;
+	}
+
+	std::cout << "slow consumer: " << count << " items of " << size << "B per producer, client processing " << itemDelay << "ms per item\n";
+	if (serverPid == 0)
+	{
+		std::cout << "set --serverPid to follow the memory of a local server\n";
+	}
+
+	std::vector<StreamResult> results;
+	for (auto c : capacities)
+	{
+		results.push_back(readStream(rpc, count, size, c, adminKey, itemDelay, serverPid, sampleInterval));
+	}
+	Stormancer::IClientFactory::ReleaseClient(0);
+
+	auto failed = false;
+	std::cout << std::setw(12) << "buffer" << std::setw(12) << "items/s" << std::setw(22) << "server RSS delta(KB)" << "\n";
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		auto& r = results[i];
+		auto name = capacities[i] > 0 ? std::to_string(capacities[i]) : std::string("unbounded");
+		auto delta = r.serverPeak - r.serverStart;
+		addCompletedOperations(r.received);
+		failed = failed || r.failed;
+		RunReport::setCounter("slowConsumer." + name + ".itemsPerSecond", r.received / r.elapsed);
+		std::cout << std::setw(12) << name << std::setw(12) << r.received / r.elapsed;
+		if (serverPid != 0)
+		{
+			RunReport::setCounter("slowConsumer." + name + ".serverRssDelta", delta);
+			std::cout << std::setw(22) << delta / 1024;
+		}
+		std::cout << "\n";
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include "Benchmarks.h"
+#include "Clients.h"
+#include "ConfigurationTemplate.h"
+#include "Process.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	struct Resource
+	{
+		const char* name;
+		const char* unit;
+		double (*sample)();
+		//Growth per iteration under which a significant trend isn't reported as a leak.
+		double tolerance;
+		std::vector<double> values;
+	};
+
+	//Connects, logs in, joins a scene and releases the client.
+	pplx::task<StressTool::Result> cycle(int id, std::string sceneId)
+	{
+		auto timer = std::make_shared<Timer>();
+		timer->start();
+		return StressTool::Clients::login(id).then([sceneId](std::shared_ptr<Stormancer::IClient> client) {
+			return client->connectToPublicScene(sceneId);
+		})
+		.then([id, timer](pplx::task<std::shared_ptr<Stormancer::Scene>> t) {
+			StressTool::Result r;
+			try
+			{
+				t.get();
+				r.success = true;
+			}
+			catch (std::exception& ex)
+			{
+				std::cout << ex.what() << "\n";
+				r.success = false;
+			}
+			Stormancer::IClientFactory::ReleaseClient(id);
+			r.duration = timer->getElapsedTimeInMilliSec();
+			return r;
+		});
+	}
+}
+
+int StressTool::runSoakBenchmark(const Options& options)
+{
+	auto duration = options.getDouble("duration", 3600);
+	auto clients = options.getInt("clients", 4);
+	auto sceneId = options.getString("scene", "test-scene");
+	auto sampleEvery = options.getInt("sampleEvery", 100);
+	//Iterations run before sampling starts, while caches and allocator pools fill.
+	auto warmup = options.getInt("warmup", 500);
+	auto reportInterval = options.getDouble("report", 60);
+	//Successive samples are correlated: the verdict fits the trend on the means of this many windows of samples.
+	auto batches = static_cast<std::size_t>(options.getInt("batches", 10));
+
+	std::vector<Resource> resources = {
+		{ "rss", "B", [] { return static_cast<double>(Process::residentMemory()); }, options.getDouble("rssTolerance", 256), {} },
+		{ "handles", "", [] { return static_cast<double>(Process::openHandles()); }, options.getDouble("handleTolerance", 0), {} },
+		{ "threads", "", [] { return static_cast<double>(Process::threadCount()); }, options.getDouble("threadTolerance", 0), {} }
+	};
+	std::vector<double> iterations;
+
+	ConfigurationTemplate().install();
+
+	std::cout << "soak: " << clients << " clients cycling login/connect/release on " << sceneId << " for " << duration << "s\n";
+	std::cout << std::setw(10) << "elapsed(s)" << std::setw(12) << "iterations" << std::setw(10) << "errors"
+		<< std::setw(14) << "rss(KB)" << std::setw(10) << "handles" << std::setw(10) << "threads" << std::setw(16) << "rss/iter(B)" << "\n";
+
+	std::vector<Result> results;
+	int completed = 0;
+	int failed = 0;
+	auto nextSample = warmup;
+	double nextReport = reportInterval;
+	Timer timer;
+	timer.start();
+	while (timer.getElapsedTimeInSec() < duration)
+	{
+		std::vector<pplx::task<Result>> tasks;
+		for (int id = 0; id < clients; id++)
+		{
+			tasks.push_back(cycle(id, sceneId));
+		}
+		auto batch = pplx::when_all(tasks.begin(), tasks.end()).get();
+		for (auto& r : batch)
+		{
+			completed++;
+			if (!r.success)
+			{
+				failed++;
+			}
+		}
+
+		if (completed >= nextSample)
+		{
+			//Only sampled batches are kept: keeping every result would grow the tool's own memory with the iterations.
+			results.insert(results.end(), batch.begin(), batch.end());
+			nextSample = completed + sampleEvery;
+			iterations.push_back(completed);
+			for (auto& resource : resources)
+			{
+				resource.values.push_back(resource.sample());
+			}
+		}
+
+		auto elapsed = timer.getElapsedTimeInSec();
+		if (elapsed >= nextReport && !iterations.empty())
+		{
+			nextReport = elapsed + reportInterval;
+			std::cout << std::setw(10) << static_cast<int>(elapsed) << std::setw(12) << completed << std::setw(10) << failed
+				<< std::setw(14) << resources[0].values.back() / 1024 << std::setw(10) << resources[1].values.back() << std::setw(10) << resources[2].values.back()
+				<< std::setw(16) << linearTrend(iterations, resources[0].values).slope << "\n";
+		}
+	}
+
+	addCompletedOperations(completed - failed);
+	RunReport::record("soak.cycle", results);
+	RunReport::setCounter("soak.iterations", completed);
+
+	if (batches < 3 || iterations.size() < batches)
+	{
+		std::cout << "not enough samples to fit a trend on " << batches << " batches (at least 3): run longer, or lower --warmup or --sampleEvery\n";
+		return 1;
+	}
+
+	//A resource leaks if its growth per iteration is above its tolerance with 95% confidence.
+	bool leaking = false;
+	std::cout << "trend over the means of " << batches << " batches of " << iterations.size() / batches << " samples, from iteration "
+		<< iterations[iterations.size() % batches] << " to " << iterations.back() << ":\n";
+	for (auto& resource : resources)
+	{
+		auto trend = batchTrend(iterations, resource.values, batches);
+		auto leak = trend.slopeInterval.low > resource.tolerance;
+		leaking = leaking || leak;
+		RunReport::setCounter(std::string("soak.") + resource.name + ".perIteration", trend.slope);
+		std::cout << std::setw(8) << resource.name << " " << resource.values.front() << " -> " << resource.values.back() << resource.unit
+			<< ", " << trend.slope << resource.unit << "/iteration [" << trend.slopeInterval.low << ", " << trend.slopeInterval.high << "]"
+			<< (leak ? "  LEAK" : "") << "\n";
+	}
+	return leaking ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+#include "Sockets.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(WIN32) || defined(_WIN32)
+#pragma comment(lib, "ws2_32.lib")
+
+StressTool::Sockets::WinsockInit::WinsockInit()
+{
+	WSADATA data;
+	WSAStartup(MAKEWORD(2, 2), &data);
+}
+
+StressTool::Sockets::WinsockInit::~WinsockInit()
+{
+	WSACleanup();
+}
+
+void StressTool::Sockets::closeSocket(Socket s)
+{
+	closesocket(s);
+}
+
+int StressTool::Sockets::pollSockets(pollfd* fds, std::size_t count, int timeoutMs)
+{
+	return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+
+bool StressTool::Sockets::setNonBlocking(Socket s)
+{
+	u_long nonBlocking = 1;
+	return ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+}
+
+bool StressTool::Sockets::wouldBlock()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+bool StressTool::Sockets::connectPending()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+namespace
+{
+	const int SendFlags = 0;
+}
+#else
+#include <cerrno>
+#include <fcntl.h>
+
+void StressTool::Sockets::closeSocket(Socket s)
+{
+	::close(s);
+}
+
+int StressTool::Sockets::pollSockets(pollfd* fds, std::size_t count, int timeoutMs)
+{
+	return ::poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+
+bool StressTool::Sockets::setNonBlocking(Socket s)
+{
+	auto flags = fcntl(s, F_GETFL, 0);
+	return flags != -1 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool StressTool::Sockets::wouldBlock()
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+bool StressTool::Sockets::connectPending()
+{
+	return errno == EINPROGRESS;
+}
+
+namespace
+{
+	//A write to a connection closed by the peer fails instead of raising SIGPIPE.
+	const int SendFlags = MSG_NOSIGNAL;
+}
+#endif
+
+bool StressTool::Sockets::resolve(const std::string& host, int port, sockaddr_in& address)
+{
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	addrinfo* info = nullptr;
+	if (getaddrinfo(host.c_str(), nullptr, &hints, &info) != 0 || !info)
+	{
+		return false;
+	}
+	address = *reinterpret_cast<sockaddr_in*>(info->ai_addr);
+	address.sin_port = htons(static_cast<std::uint16_t>(port));
+	freeaddrinfo(info);
+	return true;
+}
+
+StressTool::Sockets::Socket StressTool::Sockets::bindSocket(int type, int port, bool loopback)
+{
+	auto s = socket(AF_INET, type, 0);
+	if (s == InvalidSocket)
+	{
+		return s;
+	}
+	int reuse = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(loopback ? INADDR_LOOPBACK : INADDR_ANY);
+	address.sin_port = htons(static_cast<std::uint16_t>(port));
+	if (bind(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || (type == SOCK_STREAM && listen(s, SOMAXCONN) != 0))
+	{
+		closeSocket(s);
+		return InvalidSocket;
+	}
+	return s;
+}
+
+bool StressTool::Sockets::sendAll(Socket s, const char* data, std::size_t size)
+{
+	std::size_t sent = 0;
+	while (sent < size)
+	{
+		auto n = send(s, data + sent, static_cast<int>(size - sent), 0);
+		if (n <= 0)
+		{
+			return false;
+		}
+		sent += n;
+	}
+	return true;
+}
+
+bool StressTool::Sockets::sendAll(Socket s, const std::vector<char>& data)
+{
+	return sendAll(s, data.data(), data.size());
+}
+
+bool StressTool::Sockets::connectSucceeded(Socket s)
+{
+	int error = 0;
+	socklen_t length = sizeof(error);
+	return getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) == 0 && error == 0;
+}
+
+int StressTool::Sockets::sendSome(Socket s, const char* data, std::size_t size)
+{
+	auto n = send(s, data, static_cast<int>(size), SendFlags);
+	if (n < 0)
+	{
+		return wouldBlock() ? 0 : -1;
+	}
+	return static_cast<int>(n);
+}
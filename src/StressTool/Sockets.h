@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace StressTool
+{
+	/// <summary>
+	/// Portable helpers over BSD sockets and Winsock, shared by the proxies of the tool.
+	/// </summary>
+	namespace Sockets
+	{
+#if defined(WIN32) || defined(_WIN32)
+		using Socket = SOCKET;
+		const Socket InvalidSocket = INVALID_SOCKET;
+		const int ShutdownWrite = SD_SEND;
+		const int ShutdownBoth = SD_BOTH;
+
+		/// <summary>
+		/// Initializes Winsock for the lifetime of the object.
+		/// </summary>
+		struct WinsockInit
+		{
+			WinsockInit();
+			~WinsockInit();
+		};
+#else
+		using Socket = int;
+		const Socket InvalidSocket = -1;
+		const int ShutdownWrite = SHUT_WR;
+		const int ShutdownBoth = SHUT_RDWR;
+#endif
+
+		void closeSocket(Socket s);
+
+		int pollSockets(pollfd* fds, std::size_t count, int timeoutMs);
+
+		/// <summary>
+		/// Resolves the IPv4 address of host.
+		/// </summary>
+		bool resolve(const std::string& host, int port, sockaddr_in& address);
+
+		/// <summary>
+		/// Creates a socket of type SOCK_DGRAM or SOCK_STREAM bound to port on all interfaces, or only on 127.0.0.1 if loopback is true. Stream sockets are listening.
+		/// </summary>
+		/// <returns>InvalidSocket on failure.</returns>
+		Socket bindSocket(int type, int port, bool loopback = false);
+
+		/// <summary>
+		/// Sends all the data, unless the connection fails.
+		/// </summary>
+		bool sendAll(Socket s, const char* data, std::size_t size);
+
+		bool sendAll(Socket s, const std::vector<char>& data);
+
+		/// <summary>
+		/// Makes the operations on s return instead of blocking.
+		/// </summary>
+		bool setNonBlocking(Socket s);
+
+		/// <summary>
+		/// Sends what the socket buffer of a non-blocking socket accepts.
+		/// </summary>
+		/// <returns>The number of bytes sent, 0 if the buffer is full, -1 if the connection failed.</returns>
+		int sendSome(Socket s, const char* data, std::size_t size);
+
+		/// <summary>
+		/// Whether the last operation that failed on a non-blocking socket would have blocked.
+		/// </summary>
+		bool wouldBlock();
+
+		/// <summary>
+		/// Whether the last connect that failed on a non-blocking socket is in progress. The socket becomes writable once it completes.
+		/// </summary>
+		bool connectPending();
+
+		/// <summary>
+		/// Whether the connection of a non-blocking socket succeeded, once the socket is writable or in error.
+		/// </summary>
+		bool connectSucceeded(Socket s);
+	}
+}
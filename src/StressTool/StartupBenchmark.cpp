@@ -0,0 +1,121 @@
+#include "Allocations.h"
+#include "Benchmarks.h"
+#include "ConfigurationTemplate.h"
+#include "Process.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Timer.h"
+//Provides APIs related to authentication & user management.
+#include "Users/Users.hpp"
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	constexpr const char* ServerEndpoint = "http://localhost";
+	constexpr const char* Account = "tests";
+	constexpr const char* Application = "test";
+
+	struct StartupCost
+	{
+		double microseconds;
+		double residentBytes;
+		double allocations;
+		double allocatedBytes;
+	};
+
+	//Creates clients [firstId, firstId + count[ without connecting them, and returns the cost per client.
+	StartupCost createClients(int firstId, int count, bool perClientConfiguration)
+	{
+		auto memoryBefore = StressTool::Process::residentMemory();
+		auto allocationsBefore = StressTool::Allocations::snapshot();
+		Timer timer;
+		timer.start();
+		if (perClientConfiguration)
+		{
+			//What the login mode does: a configurator registered and a configuration built for each client.
+			for (int id = firstId; id < firstId + count; id++)
+			{
+				Stormancer::IClientFactory::SetConfig(id, [](size_t) {
+					auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+					config->addPlugin(new Stormancer::Users::UsersPlugin());
+					return config;
+				});
+				Stormancer::IClientFactory::GetClient(id);
+			}
+		}
+		else
+		{
+			//One default configurator for all the clients, creating each configuration from the shared template.
+			StressTool::ConfigurationTemplate().install();
+			for (int id = firstId; id < firstId + count; id++)
+			{
+				Stormancer::IClientFactory::GetClient(id);
+			}
+		}
+		timer.stop();
+		auto memoryAfter = StressTool::Process::residentMemory();
+		auto allocationsAfter = StressTool::Allocations::snapshot();
+
+		StartupCost cost;
+		cost.microseconds = timer.getElapsedTimeInMicroSec() / count;
+		cost.residentBytes = (static_cast<double>(memoryAfter) - static_cast<double>(memoryBefore)) / count;
+		cost.allocations = static_cast<double>(allocationsAfter.count - allocationsBefore.count) / count;
+		cost.allocatedBytes = static_cast<double>(allocationsAfter.bytes - allocationsBefore.bytes) / count;
+
+		for (int id = firstId; id < firstId + count; id++)
+		{
+			Stormancer::IClientFactory::ReleaseClient(id);
+		}
+		return cost;
+	}
+
+	void print(const char* name, const StartupCost& cost)
+	{
+		std::cout << std::setw(12) << name << std::setw(12) << cost.microseconds << std::setw(14) << cost.residentBytes;
+		if (StressTool::Allocations::enabled())
+		{
+			std::cout << std::setw(12) << cost.allocations << std::setw(14) << cost.allocatedBytes;
+		}
+		std::cout << "\n";
+	}
+}
+
+int StressTool::runStartupBenchmark(const Options& options)
+{
+	auto nbClients = options.getInt("clients", 1000);
+	auto rounds = options.getInt("rounds", 2);
+
+	std::cout << "startup cost of " << nbClients << " clients, per client" << (Allocations::enabled() ? "" : " (build with STRESSTOOL_TRACK_ALLOCATIONS to count allocations)") << "\n";
+	std::cout << std::setw(12) << "config" << std::setw(12) << "us" << std::setw(14) << "RSS bytes";
+	if (Allocations::enabled())
+	{
+		std::cout << std::setw(12) << "allocs" << std::setw(14) << "alloc bytes";
+	}
+	std::cout << "\n";
+
+	//Each round uses new client ids: ids configured with SetConfig keep their own configurator.
+	//Rounds alternate both variants, so that allocator and page cache warm up benefits both.
+	int nextId = 0;
+	for (int round = 0; round < rounds; round++)
+	{
+		auto perClient = createClients(nextId, nbClients, true);
+		nextId += nbClients;
+		auto shared = createClients(nextId, nbClients, false);
+		nextId += nbClients;
+		print("per client", perClient);
+		print("template", shared);
+
+		if (round == rounds - 1)
+		{
+			RunReport::setCounter("startup.perClient.microseconds", perClient.microseconds);
+			RunReport::setCounter("startup.perClient.residentBytes", perClient.residentBytes);
+			RunReport::setCounter("startup.perClient.allocations", perClient.allocations);
+			RunReport::setCounter("startup.template.microseconds", shared.microseconds);
+			RunReport::setCounter("startup.template.residentBytes", shared.residentBytes);
+			RunReport::setCounter("startup.template.allocations", shared.allocations);
+		}
+	}
+	addCompletedOperations(static_cast<std::uint64_t>(nbClients) * rounds * 2);
+	return 0;
+}
@@ -0,0 +1,208 @@
+#define NOMINMAX
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace
+{
+	std::atomic<std::uint64_t> operations{ 0 };
+
+	//Two sided 97.5% quantiles of Student's t distribution for 1 to 30 degrees of freedom, then the normal approximation.
+	double tQuantile(std::size_t degrees)
+	{
+		static const double t[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+			2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+			2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+		return degrees <= 30 ? t[degrees - 1] : 1.96;
+	}
+}
+
+double StressTool::percentile(const std::vector<double>& sortedValues, double p)
+{
+	if (sortedValues.empty())
+	{
+		return 0;
+	}
+	auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sortedValues.size()));
+	if (rank > 0)
+	{
+		rank--;
+	}
+	return sortedValues[std::min(rank, sortedValues.size() - 1)];
+}
+
+StressTool::Stats StressTool::stats(const std::vector<Result>& results)
+{
+	std::vector<double> durations;
+	durations.reserve(results.size());
+	double acc = 0;
+
+	for (auto& v : results)
+	{
+		if (v.success)
+		{
+			acc += v.duration;
+			durations.push_back(v.duration);
+		}
+	}
+	std::sort(durations.begin(), durations.end());
+
+	Stats stats;
+	stats.count = durations.size();
+	stats.avg = durations.empty() ? 0 : acc / durations.size();
+	stats.min = durations.empty() ? 0 : durations.front();
+	stats.max = durations.empty() ? 0 : durations.back();
+	stats.p50 = percentile(durations, 50);
+	stats.p90 = percentile(durations, 90);
+	stats.p99 = percentile(durations, 99);
+	stats.p999 = percentile(durations, 99.9);
+	stats.successRate = results.empty() ? 0 : static_cast<double>(durations.size()) / results.size();
+	return stats;
+}
+
+void StressTool::print(std::ostream& out, const Stats& stats)
+{
+	out << "success rate : " << stats.successRate * 100 << "%\n";
+	out << "avg          : " << stats.avg << "ms\n";
+	out << "min          : " << stats.min << "ms\n";
+	out << "p50          : " << stats.p50 << "ms\n";
+	out << "p90          : " << stats.p90 << "ms\n";
+	out << "p99          : " << stats.p99 << "ms\n";
+	out << "p99.9        : " << stats.p999 << "ms\n";
+	out << "max          : " << stats.max << "ms\n";
+}
+
+void StressTool::addCompletedOperations(std::uint64_t count)
+{
+	operations += count;
+}
+
+std::uint64_t StressTool::completedOperations()
+{
+	return operations;
+}
+
+StressTool::Interval StressTool::meanInterval(const std::vector<double>& values)
+{
+	if (values.empty())
+	{
+		return { 0, 0 };
+	}
+	double sum = 0;
+	for (auto v : values)
+	{
+		sum += v;
+	}
+	auto mean = sum / values.size();
+	if (values.size() < 2)
+	{
+		return { mean, mean };
+	}
+	double squares = 0;
+	for (auto v : values)
+	{
+		squares += (v - mean) * (v - mean);
+	}
+	auto standardError = std::sqrt(squares / (values.size() - 1) / values.size());
+	auto quantile = tQuantile(values.size() - 1);
+	return { mean - quantile * standardError, mean + quantile * standardError };
+}
+
+StressTool::Trend StressTool::linearTrend(const std::vector<double>& x, const std::vector<double>& y)
+{
+	Trend trend{ 0, 0, { 0, 0 } };
+	auto n = std::min(x.size(), y.size());
+	if (n < 3)
+	{
+		return trend;
+	}
+	double meanX = 0;
+	double meanY = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		meanX += x[i];
+		meanY += y[i];
+	}
+	meanX /= n;
+	meanY /= n;
+	double sxx = 0;
+	double sxy = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		sxx += (x[i] - meanX) * (x[i] - meanX);
+		sxy += (x[i] - meanX) * (y[i] - meanY);
+	}
+	if (sxx == 0)
+	{
+		return trend;
+	}
+	trend.slope = sxy / sxx;
+	trend.intercept = meanY - trend.slope * meanX;
+
+	double residuals = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		auto r = y[i] - (trend.intercept + trend.slope * x[i]);
+		residuals += r * r;
+	}
+	auto standardError = std::sqrt(residuals / (n - 2) / sxx);
+	auto quantile = tQuantile(n - 2);
+	trend.slopeInterval = { trend.slope - quantile * standardError, trend.slope + quantile * standardError };
+	return trend;
+}
+
+StressTool::Trend StressTool::batchTrend(const std::vector<double>& x, const std::vector<double>& y, std::size_t batches)
+{
+	auto n = std::min(x.size(), y.size());
+	batches = std::min(batches, n);
+	if (batches < 3)
+	{
+		return Trend{ 0, 0, { 0, 0 } };
+	}
+	auto size = n / batches;
+	auto first = n - batches * size;
+	std::vector<double> batchX;
+	std::vector<double> batchY;
+	for (std::size_t b = 0; b < batches; b++)
+	{
+		double sumX = 0;
+		double sumY = 0;
+		for (auto i = first + b * size; i < first + (b + 1) * size; i++)
+		{
+			sumX += x[i];
+			sumY += y[i];
+		}
+		batchX.push_back(sumX / size);
+		batchY.push_back(sumY / size);
+	}
+	return linearTrend(batchX, batchY);
+}
+
+StressTool::Interval StressTool::percentileInterval(const std::vector<double>& values, double p, int iterations)
+{
+	if (values.empty())
+	{
+		return { 0, 0 };
+	}
+	//Fixed seed: the same samples give the same interval.
+	std::mt19937 random(42);
+	std::uniform_int_distribution<std::size_t> pick(0, values.size() - 1);
+	std::vector<double> resample(values.size());
+	std::vector<double> estimates;
+	estimates.reserve(iterations);
+	auto index = std::min(values.size() - 1, static_cast<std::size_t>(std::max(1.0, std::ceil(p / 100.0 * values.size()))) - 1);
+	for (int i = 0; i < iterations; i++)
+	{
+		for (auto& v : resample)
+		{
+			v = values[pick(random)];
+		}
+		std::nth_element(resample.begin(), resample.begin() + index, resample.end());
+		estimates.push_back(resample[index]);
+	}
+	std::sort(estimates.begin(), estimates.end());
+	return { percentile(estimates, 2.5), percentile(estimates, 97.5) };
+}
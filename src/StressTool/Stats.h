@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Worker.h"
+
+namespace StressTool
+{
+	struct Stats
+	{
+		double avg;
+		double max;
+		double min;
+		double p50;
+		double p90;
+		double p99;
+		double p999;
+		double successRate;
+		std::size_t count;
+	};
+
+	/// <summary>
+	/// Computes latency statistics over the successful results of a run.
+	/// </summary>
+	Stats stats(const std::vector<Result>& results);
+
+	/// <summary>
+	/// Returns the nearest-rank percentile p (0-100) of a sorted set of values.
+	/// </summary>
+	double percentile(const std::vector<double>& sortedValues, double p);
+
+	void print(std::ostream& out, const Stats& stats);
+
+	struct Interval
+	{
+		double low;
+		double high;
+	};
+
+	/// <summary>
+	/// 95% confidence interval of the mean of independent values, such as the means of successive batches, using Student's t distribution.
+	/// </summary>
+	Interval meanInterval(const std::vector<double>& values);
+
+	struct Trend
+	{
+		double slope;
+		double intercept;
+		Interval slopeInterval;
+	};
+
+	/// <summary>
+	/// Least squares fit of y = intercept + slope * x, with the 95% confidence interval of the slope.
+	/// </summary>
+	/// <remarks>
+	/// The interval assumes independent residuals. It is too narrow for autocorrelated series, such as resource usage sampled often.
+	/// </remarks>
+	Trend linearTrend(const std::vector<double>& x, const std::vector<double>& y);
+
+	/// <summary>
+	/// Least squares fit of y = intercept + slope * x on the means of up to `batches` consecutive, non-overlapping windows of the samples.
+	/// </summary>
+	/// <remarks>
+	/// Batch means of windows longer than the correlation time of the series are close to independent, so the 95% interval of the slope,
+	/// a t-interval with batches - 2 degrees of freedom, holds for autocorrelated series where the interval of linearTrend is too narrow.
+	/// The oldest samples that don't fill a window are ignored.
+	/// </remarks>
+	Trend batchTrend(const std::vector<double>& x, const std::vector<double>& y, std::size_t batches);
+
+	/// <summary>
+	/// Bootstrap 95% confidence interval of the percentile p (0-100) of values.
+	/// </summary>
+	Interval percentileInterval(const std::vector<double>& values, double p, int iterations = 200);
+
+	/// <summary>
+	/// Records operations completed by a benchmark (logins, RPCs...), used to normalize process wide measures per operation.
+	/// </summary>
+	void addCompletedOperations(std::uint64_t count);
+
+	std::uint64_t completedOperations();
+}
@@ -1,55 +1,44 @@
 // StressTool.cpp : Ce fichier contient la fonction 'main'. L'exécution du programme commence et se termine à cet endroit.
 //
 #define NOMINMAX
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include "Affinity.h"
+#include "Allocations.h"
+#include "Benchmarks.h"
+#include "ConfigurationTemplate.h"
+#include "MetadataCache.h"
+#include "PerfCounters.h"
+#include "RunReport.h"
+#include "Stats.h"
+#include "Trace.h"
 #include "Worker.h"
 #include "Timer.h"
 
-
-struct Stats
-{
-    double avg;
-    double max;
-    double min;
-    double successRate;
-};
-Stats stats(std::vector<StressTool::Result> results)
+int runLoginBenchmark(const StressTool::Options& options)
 {
-    double acc = 0;
-    double count = 0;
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::min();
-    
-    for (auto v : results)
-    {
-        if (v.success)
-        {
+    auto iterations = options.getInt("iterations", 1000);
+    int concurrentWorkers = options.getInt("batch", 10);
+    //Batches started during the warm up (server JIT, connection pools, scene caches) are discarded.
+    auto warmup = options.getDouble("warmup", 30);
+    //Stops when the 95% confidence intervals of throughput and p99 are narrower than this fraction of their value. 0 runs all iterations.
+    auto ciTarget = options.getDouble("ciTarget", 0);
+    auto minBatches = options.getInt("minBatches", 30);
+    //Prints every batch when 0 or less.
+    auto reportEvery = std::max(1, options.getInt("reportEvery", 10));
 
-            acc += v.duration;
-            count++;
-            if (min > v.duration)
-            {
-                min = v.duration;
-            }
-            if (max < v.duration)
-            {
-                max = v.duration;
-            }
-        }
-    }
-    Stats stats;
-    stats.avg = acc / count;
-    stats.max = max;
-    stats.min = min;
-    stats.successRate = count / results.size();
-    return stats;
-}
-int main()
-{
-    for (int l=0; l < 1000; l++)
-    {
-        int concurrentWorkers = 10;
+    std::vector<double> measured;
+    std::vector<double> batchThroughputs;
+    std::size_t measuredOperations = 0;
+    Timer runTimer;
+    runTimer.start();
 
+    for (int l=0; l < iterations; l++)
+    {
+        auto warmingUp = runTimer.getElapsedTimeInSec() < warmup;
         std::vector<pplx::task<StressTool::Result>> tasks;
 
         Timer timer;
@@ -71,18 +60,206 @@ int main()
         timer.start();
         auto results = pplx::when_all(tasks.begin(), tasks.end()).get();
         timer.stop();
-        std::cout << "execution time : " << timer.getElapsedTimeInMilliSec() << "ms\n";
-        auto result = stats(results);
-
-        std::cout << "success rate : " << result.successRate * 100 << "%\n";
-        std::cout << "avg          : " << result.avg << "ms\n";
-        std::cout << "min          : " << result.min << "ms\n";
-        std::cout << "max          : " << result.max << "ms\n";
-       
-      
-    }
-    std::string _;
-    std::getline(std::cin, _);
+        std::cout << "execution time : " << timer.getElapsedTimeInMilliSec() << "ms" << (warmingUp ? " (warm up, discarded)" : "") << "\n";
+        auto result = StressTool::stats(results);
+        StressTool::addCompletedOperations(result.count);
+        if (warmingUp)
+        {
+            continue;
+        }
+
+        StressTool::RunReport::record("login", results);
+        measuredOperations += results.size();
+        for (auto& r : results)
+        {
+            if (r.success)
+            {
+                measured.push_back(r.duration);
+            }
+        }
+        //Batches are independent, so their throughputs can be treated as batch means.
+        batchThroughputs.push_back(result.count / timer.getElapsedTimeInSec());
+
+        auto batches = static_cast<int>(batchThroughputs.size());
+        if (batches % reportEvery != 0 && l != iterations - 1)
+        {
+            continue;
+        }
+
+        //Cumulative statistics of all measured batches.
+        std::vector<double> sorted(measured);
+        std::sort(sorted.begin(), sorted.end());
+        auto throughput = StressTool::meanInterval(batchThroughputs);
+        auto p50 = StressTool::percentileInterval(measured, 50);
+        auto p99 = StressTool::percentileInterval(measured, 99);
+        auto meanThroughput = (throughput.low + throughput.high) / 2;
+        auto throughputWidth = meanThroughput > 0 ? (throughput.high - throughput.low) / 2 / meanThroughput : 0;
+        auto p99Value = StressTool::percentile(sorted, 99);
+        auto p99Width = p99Value > 0 ? (p99.high - p99.low) / 2 / p99Value : 0;
+
+        std::cout << batches << " batches, " << measured.size() << " logins, success rate " << 100.0 * measured.size() / measuredOperations << "%\n";
+        std::cout << "  throughput : " << meanThroughput << "/s [" << throughput.low << " - " << throughput.high << "] +/-" << throughputWidth * 100 << "%\n";
+        std::cout << "  p50        : " << StressTool::percentile(sorted, 50) << "ms [" << p50.low << " - " << p50.high << "]\n";
+        std::cout << "  p99        : " << p99Value << "ms [" << p99.low << " - " << p99.high << "] +/-" << p99Width * 100 << "%\n";
+
+        if (ciTarget > 0 && batches >= minBatches && throughputWidth <= ciTarget && p99Width <= ciTarget)
+        {
+            std::cout << "confidence intervals within " << ciTarget * 100 << "%, stopping\n";
+            break;
+        }
+    }
+    StressTool::RunReport::setCounter("login.measuredBatches", static_cast<double>(batchThroughputs.size()));
+    //Keeps the console open when run interactively. With --output, the run is scripted and the report is written after this returns.
+    if (!options.has("output"))
+    {
+        std::string _;
+        std::getline(std::cin, _);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    StressTool::Options options(argc, argv);
+
+    const std::map<std::string, std::function<int(const StressTool::Options&)>> modes = {
+        { "login", runLoginBenchmark },
+        { "massconnect", StressTool::runMassConnectBenchmark },
+        { "appfunction", StressTool::runAppFunctionBenchmark },
+        { "relay", StressTool::runSceneRelayBenchmark },
+        { "p2p", StressTool::runP2PBenchmark },
+        { "peerconfig", StressTool::runPeerConfigurationBenchmark },
+        { "partychurn", StressTool::runPartyChurnBenchmark },
+        { "payload", StressTool::runPayloadSweepBenchmark },
+        { "rejection", StressTool::runRejectionBenchmark },
+        { "serverrequest", StressTool::runServerRequestBenchmark },
+        { "slowconsumer", StressTool::runSlowConsumerBenchmark },
+        { "capacity", StressTool::runCapacityBenchmark },
+        { "ccu", StressTool::runCcuBenchmark },
+        { "encryption", StressTool::runEncryptionBenchmark },
+        { "startup", StressTool::runStartupBenchmark },
+        { "dispatcher", StressTool::runDispatcherBenchmark },
+        { "soak", StressTool::runSoakBenchmark },
+        { "proxy", StressTool::runProxy },
+        { "compare", StressTool::runCompare }
+    };
+
+    auto mode = modes.find(options.mode());
+    if (mode == modes.end())
+    {
+        std::cout << "unknown mode '" << options.mode() << "'. Available modes:\n";
+        for (auto& m : modes)
+        {
+            std::cout << "  " << m.first << "\n";
+        }
+        return 1;
+    }
+
+    //Pin the main thread before clients are created: library and pplx threads inherit its affinity.
+    std::vector<int> loadCpus;
+    if (options.has("numaNode") && !StressTool::Affinity::numaNodeCpus(options.getInt("numaNode", 0), loadCpus))
+    {
+        std::cout << "can't get the CPUs of NUMA node " << options.getString("numaNode", "") << "\n";
+        return 2;
+    }
+    if (options.has("cpus") && !StressTool::Affinity::parse(options.getString("cpus", ""), loadCpus))
+    {
+        std::cout << "invalid CPU list '" << options.getString("cpus", "") << "'\n";
+        return 2;
+    }
+    if (!loadCpus.empty())
+    {
+        if (!StressTool::Affinity::pinCurrentThread(loadCpus))
+        {
+            std::cout << "failed to pin load generating threads to CPUs " << StressTool::Affinity::format(loadCpus) << "\n";
+            return 2;
+        }
+        std::cout << "load generating threads pinned to CPUs " << StressTool::Affinity::format(loadCpus) << "\n";
+    }
+    if (options.has("measureCpus"))
+    {
+        std::vector<int> measureCpus;
+        if (!StressTool::Affinity::parse(options.getString("measureCpus", ""), measureCpus))
+        {
+            std::cout << "invalid CPU list '" << options.getString("measureCpus", "") << "'\n";
+            return 2;
+        }
+        StressTool::Affinity::setMeasuringCpus(measureCpus);
+        std::cout << "measuring threads pinned to CPUs " << StressTool::Affinity::format(measureCpus) << "\n";
+    }
+    auto coreTimesBefore = StressTool::Affinity::coreTimes();
+
+    //Counters are opened before the benchmark creates clients, so that library threads are counted from their start.
+    StressTool::PerfCounters perf;
+    if (options.getBool("perf", false))
+    {
+        perf.start();
+        if (!perf.available())
+        {
+            std::cout << "perf counters unavailable : " << perf.error() << "\n";
+        }
+    }
+
+    if (options.has("trace"))
+    {
+        StressTool::Trace::start();
+    }
+
+    //Clients get the endpoints and federation of the server from a cache shared by the process, instead of an HTTP request each.
+    std::unique_ptr<StressTool::MetadataCache> metadataCache;
+    if (options.getBool("metadataCache", false))
+    {
+        metadataCache.reset(new StressTool::MetadataCache(StressTool::ConfigurationTemplate::serverEndpoint(), options.getDouble("metadataCacheTtl", 30)));
+        if (!metadataCache->start())
+        {
+            std::cout << "metadata cache: " << metadataCache->error() << "\n";
+            return 2;
+        }
+        StressTool::ConfigurationTemplate::setDefaultEndpoint(metadataCache->endpoint());
+    }
+
+    auto result = mode->second(options);
+
+    if (metadataCache)
+    {
+        auto& counters = metadataCache->counters();
+        std::cout << "metadata cache: " << counters.hits << " hits, " << counters.misses << " misses (" << counters.coalesced << " coalesced), " << counters.forwarded << " forwarded\n";
+    }
+
+    if (options.getBool("perf", false) && perf.available())
+    {
+        perf.stop();
+        perf.print(std::cout, StressTool::completedOperations());
+    }
+    if (options.getBool("cpuUsage", false))
+    {
+        StressTool::Affinity::printCoreUsage(std::cout, coreTimesBefore, StressTool::Affinity::coreTimes());
+    }
+    if (StressTool::Allocations::enabled())
+    {
+        StressTool::Allocations::print(std::cout, StressTool::completedOperations());
+    }
+    if (options.has("output"))
+    {
+        auto path = options.getString("output", "");
+        if (!StressTool::RunReport::save(path, options))
+        {
+            std::cout << "failed to write results to " << path << "\n";
+            return 2;
+        }
+        std::cout << "results written to " << path << "\n";
+    }
+    if (options.has("trace"))
+    {
+        auto path = options.getString("trace", "");
+        if (!StressTool::Trace::save(path))
+        {
+            std::cout << "failed to write trace to " << path << "\n";
+            return 2;
+        }
+        std::cout << "trace written to " << path << "\n";
+    }
+    return result;
 }
 
 // Exécuter le programme : Ctrl+F5 ou menu Déboguer > Exécuter sans débogage
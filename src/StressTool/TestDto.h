@@ -0,0 +1,18 @@
+#pragma once
+#include "stormancer/Serializer.h"
+#include <string>
+
+namespace StressTool
+{
+	/// <summary>
+	/// C++ mirror of TestDto in src/server/S2SController.cs, members in declaration order.
+	/// </summary>
+	struct TestDto
+	{
+		std::string value;
+		bool boolean = false;
+		int number = 0;
+
+		MSGPACK_DEFINE(value, boolean, number)
+	};
+}
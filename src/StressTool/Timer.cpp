@@ -99,8 +99,8 @@ double Timer::getElapsedTimeInNanoSec()
     if (!stopped)
         gettimeofday(&endCount, NULL);
 
-    startTimeInNanoSec = (startCount.tv_sec * 1000000000.0) + startCount.tv_nsec;
-    endTimeInNanoSec = (endCount.tv_sec * 1000000000.0) + endCount.tv_nsec;
+    startTimeInNanoSec = (startCount.tv_sec * 1000000000.0) + startCount.tv_usec * 1000.0;
+    endTimeInNanoSec = (endCount.tv_sec * 1000000000.0) + endCount.tv_usec * 1000.0;
 #endif
 
     return endTimeInNanoSec - startTimeInNanoSec;
@@ -0,0 +1,145 @@
+#include "Trace.h"
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct Span
+	{
+		const char* name;
+		int client;
+		StressTool::Trace::TimePoint start;
+		StressTool::Trace::TimePoint end;
+	};
+
+	struct ThreadBuffer
+	{
+		int index;
+		//Only contended while the trace is saved.
+		std::mutex mutex;
+		std::vector<Span> spans;
+	};
+
+	std::atomic<bool> recording{ false };
+	StressTool::Trace::TimePoint origin;
+
+	std::mutex buffersMutex;
+	//Buffers are never freed, so that spans of exited threads are kept.
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+	thread_local ThreadBuffer* currentBuffer = nullptr;
+
+	ThreadBuffer& buffer()
+	{
+		if (!currentBuffer)
+		{
+			std::lock_guard<std::mutex> lg(buffersMutex);
+			buffers.emplace_back(new ThreadBuffer());
+			currentBuffer = buffers.back().get();
+			currentBuffer->index = static_cast<int>(buffers.size());
+			currentBuffer->spans.reserve(4096);
+		}
+		return *currentBuffer;
+	}
+
+	double microseconds(StressTool::Trace::TimePoint time)
+	{
+		return std::chrono::duration<double, std::micro>(time - origin).count();
+	}
+
+	//Trace pids, used to group tracks.
+	constexpr int ClientsPid = 1;
+	constexpr int ThreadsPid = 2;
+
+	void writeEvent(std::ofstream& file, bool& first, const Span& span, int pid, int tid)
+	{
+		file << (first ? "\n" : ",\n");
+		first = false;
+		file << "{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+			<< ",\"ts\":" << microseconds(span.start) << ",\"dur\":" << microseconds(span.end) - microseconds(span.start)
+			<< ",\"args\":{\"client\":" << span.client << "}}";
+	}
+
+	//A span completed on a thread may have started on another one: the thread track only shows its completion, as an instant event.
+	void writeCompletion(std::ofstream& file, bool& first, const Span& span, int pid, int tid)
+	{
+		file << (first ? "\n" : ",\n");
+		first = false;
+		file << "{\"name\":\"" << span.name << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":" << pid << ",\"tid\":" << tid
+			<< ",\"ts\":" << microseconds(span.end)
+			<< ",\"args\":{\"client\":" << span.client << ",\"durationMs\":" << (microseconds(span.end) - microseconds(span.start)) / 1000 << "}}";
+	}
+
+	void writeName(std::ofstream& file, bool& first, const char* kind, int pid, int tid, const std::string& name)
+	{
+		file << (first ? "\n" : ",\n");
+		first = false;
+		file << "{\"name\":\"" << kind << "\",\"ph\":\"M\",\"pid\":" << pid;
+		if (tid >= 0)
+		{
+			file << ",\"tid\":" << tid;
+		}
+		file << ",\"args\":{\"name\":\"" << name << "\"}}";
+	}
+}
+
+void StressTool::Trace::start()
+{
+	origin = now();
+	recording = true;
+}
+
+bool StressTool::Trace::enabled()
+{
+	return recording;
+}
+
+void StressTool::Trace::span(const char* name, int client, TimePoint start, TimePoint end)
+{
+	if (!recording)
+	{
+		return;
+	}
+	auto& b = buffer();
+	std::lock_guard<std::mutex> lg(b.mutex);
+	b.spans.push_back(Span{ name, client, start, end });
+}
+
+bool StressTool::Trace::save(const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary);
+	file.precision(3);
+	file << std::fixed << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	writeName(file, first, "process_name", ClientsPid, -1, "clients");
+	writeName(file, first, "process_name", ThreadsPid, -1, "threads");
+
+	std::vector<bool> namedClients;
+	std::lock_guard<std::mutex> lg(buffersMutex);
+	for (auto& b : buffers)
+	{
+		std::lock_guard<std::mutex> bufferLock(b->mutex);
+		writeName(file, first, "thread_name", ThreadsPid, b->index, "thread " + std::to_string(b->index));
+		for (auto& span : b->spans)
+		{
+			if (span.client >= 0)
+			{
+				if (static_cast<std::size_t>(span.client) >= namedClients.size())
+				{
+					namedClients.resize(span.client + 1);
+				}
+				if (!namedClients[span.client])
+				{
+					namedClients[span.client] = true;
+					writeName(file, first, "thread_name", ClientsPid, span.client, "client " + std::to_string(span.client));
+				}
+				writeEvent(file, first, span, ClientsPid, span.client);
+			}
+			writeCompletion(file, first, span, ThreadsPid, b->index);
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+namespace StressTool
+{
+	/// <summary>
+	/// Records spans of virtual clients, to be written as a Chrome trace (chrome://tracing, or ui.perfetto.dev).
+	/// </summary>
+	/// <remarks>
+	/// Each thread appends to its own buffer, so recording a span doesn't take a contended lock nor allocates, except when the buffer grows.
+	/// The trace shows the spans on one track per client, and their completions as instant events on one track per thread that completed spans
+	/// (library and pplx threads running continuations): a span can start on another thread than the one completing it, so it can't be drawn as a slice there.
+	/// </remarks>
+	namespace Trace
+	{
+		using TimePoint = std::chrono::steady_clock::time_point;
+
+		/// <summary>
+		/// Starts recording. Until called, span() does nothing.
+		/// </summary>
+		void start();
+
+		bool enabled();
+
+		inline TimePoint now()
+		{
+			return std::chrono::steady_clock::now();
+		}
+
+		/// <summary>
+		/// Records a span of the client <c>client</c>, completed on the calling thread.
+		/// </summary>
+		/// <param name="name">Name of the span. It must outlive the trace, usually a string literal.</param>
+		void span(const char* name, int client, TimePoint start, TimePoint end);
+
+		/// <summary>
+		/// Writes the spans recorded so far as a Chrome trace JSON file.
+		/// </summary>
+		bool save(const std::string& path);
+	}
+}
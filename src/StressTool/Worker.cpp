@@ -1,23 +1,27 @@
 #include "Worker.h"
 #include "Timer.h"
+#include "Allocations.h"
+#include "ConfigurationTemplate.h"
+#include "Trace.h"
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
 #include "stormancer/Logger/VisualStudioLogger.h"
 //Provides APIs related to authentication & user management.
 #include "Users/Users.hpp"
 
-constexpr const char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr const char* Account = "tests";
 constexpr const char* Application = "test";
 
 pplx::task<StressTool::Result> StressTool::ConnectionWorker::run(int id)
 {
+	StressTool::Allocations::Step configureStep("configure");
 	auto timer = std::make_shared<Timer>();
 	//Create a configuration associated with the client of id 0.
 	Stormancer::IClientFactory::SetConfig(id, [](size_t) {
+		StressTool::Allocations::Step step("createConfiguration");
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(StressTool::ConfigurationTemplate::defaultEndpoint(), std::string(Account), std::string(Application));
 		//config->logger = std::make_shared<Stormancer::VisualStudioLogger>();
 		//Add plugins required by the test.
 		config->addPlugin(new Stormancer::Users::UsersPlugin());
@@ -27,7 +31,10 @@ pplx::task<StressTool::Result> StressTool::ConnectionWorker::run(int id)
 	});
 
 	//Gets client with id 0.
-	auto client = Stormancer::IClientFactory::GetClient(id);
+	auto client = [id]() {
+		StressTool::Allocations::Step step("createClient");
+		return Stormancer::IClientFactory::GetClient(id);
+	}();
 
 	auto users = client->dependencyResolver().resolve<Stormancer::Users::UsersApi>();
 
@@ -45,10 +52,14 @@ pplx::task<StressTool::Result> StressTool::ConnectionWorker::run(int id)
 	//so call this method to login earlier, for instance during game or online menu loading as a form of "preload".
 
 
+	StressTool::Allocations::Step loginStep("login");
 	timer->start();
+	auto loginStart = StressTool::Trace::now();
 	//login() returns an asynchronous task, which calls the continuation function specified as argument of then() when it is completed.
 	// t.get() blocks until completion 
-	return users->login().then([timer,id](pplx::task<void> t) {
+	return users->login().then([timer,id,loginStart](pplx::task<void> t) {
+		StressTool::Trace::span("login", id, loginStart, StressTool::Trace::now());
+		StressTool::Allocations::Step step("release");
 		Stormancer::IClientFactory::ReleaseClient(id);
 		Result r;
 		r.duration = timer->getElapsedTimeInMilliSec();
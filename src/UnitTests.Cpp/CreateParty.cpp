@@ -1,4 +1,5 @@
 #include "pch.h"
+#include "TestServer.h"
 
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
@@ -13,7 +14,6 @@
 //Declares MainThreadActionDispatcher, a class that enables the dev to run stormancer callbacks & continuations on the thread of their choice.
 #include "stormancer/IActionDispatcher.h"
 
-constexpr  char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr  char* Account = "tests";
 constexpr  char* Application = "test";
 
@@ -26,7 +26,7 @@ TEST(GameFlow, CreateParty) {
 	Stormancer::IClientFactory::SetConfig(0, [dispatcher](size_t) {
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(testServerEndpoint(), std::string(Account), std::string(Application));
 
 		//Add plugins required by the test.
 		config->addPlugin(new Stormancer::Users::UsersPlugin());
@@ -1,4 +1,5 @@
 #include "pch.h"
+#include "TestServer.h"
 
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
@@ -13,7 +14,6 @@
 #include "stormancer/IActionDispatcher.h"
 #include "stormancer/Logger/FileLogger.h"
 
-constexpr  char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr  char* Account = "tests";
 constexpr  char* Application = "test";
 
@@ -95,7 +95,7 @@ TEST(GameFlow, FindGame) {
 	Stormancer::IClientFactory::SetDefaultConfigurator([dispatcher](size_t id) {
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(testServerEndpoint(), std::string(Account), std::string(Application));
 		config->logger = std::make_shared<Stormancer::FileLogger>(std::to_string(id),std::to_string(id)+".logs.txt");
 		//Add plugins required by the test.
 		config->addPlugin(new Stormancer::Users::UsersPlugin());
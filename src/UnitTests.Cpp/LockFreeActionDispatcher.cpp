@@ -0,0 +1,70 @@
+#include "pch.h"
+
+#include "../StressTool/LockFreeActionDispatcher.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	//Producers outnumber the slots of a small queue, so that posts keep switching between the queue and the overflow list while update() drains them.
+	void checkProducerOrder(int producers, int postsPerProducer)
+	{
+		StressTool::LockFreeActionDispatcher dispatcher(2, 1);
+
+		//Only written by the thread running update().
+		std::vector<std::vector<int>> received(producers);
+		std::atomic<int> finished{ 0 };
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; p++)
+		{
+			threads.emplace_back([&dispatcher, &received, &finished, p, postsPerProducer]() {
+				for (int i = 0; i < postsPerProducer; i++)
+				{
+					dispatcher.post([&received, p, i]() {
+						received[p].push_back(i);
+					});
+				}
+				finished++;
+			});
+		}
+
+		std::size_t total = 0;
+		while (finished < producers || total < static_cast<std::size_t>(producers) * postsPerProducer)
+		{
+			dispatcher.update(std::chrono::milliseconds(1));
+			total = 0;
+			for (auto& sequence : received)
+			{
+				total += sequence.size();
+			}
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (int p = 0; p < producers; p++)
+		{
+			ASSERT_EQ(postsPerProducer, static_cast<int>(received[p].size()));
+			for (int i = 0; i < postsPerProducer; i++)
+			{
+				ASSERT_EQ(i, received[p][i]) << "producer " << p;
+			}
+		}
+	}
+}
+
+TEST(LockFreeActionDispatcher, KeepsTheOrderOfEachProducer) {
+
+	//The reordering this guards against needs a producer to be preempted between claiming a slot and writing it: repeat to make it likely.
+	for (int round = 0; round < 20; round++)
+	{
+		checkProducerOrder(16, 20000);
+		if (HasFatalFailure())
+		{
+			return;
+		}
+	}
+}
@@ -1,4 +1,5 @@
 #include "pch.h"
+#include "TestServer.h"
 
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
@@ -14,7 +15,6 @@
 //Declares MainThreadActionDispatcher, a class that enables the dev to run stormancer callbacks & continuations on the thread of their choice.
 #include "stormancer/IActionDispatcher.h"
 
-constexpr  char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr  char* Account = "tests";
 constexpr  char* Application = "test";
 
@@ -29,7 +29,7 @@ TEST(GameFlow, ReceiveNotification) {
 	Stormancer::IClientFactory::SetConfig(0, [dispatcher](size_t) {
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(testServerEndpoint(), std::string(Account), std::string(Application));
 		config->logger = std::make_shared<Stormancer::FileLogger>(std::to_string(0), std::to_string(0) + ".logs.txt");
 
 		//Add plugins required by the test.
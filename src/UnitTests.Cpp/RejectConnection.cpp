@@ -1,4 +1,5 @@
 #include "pch.h"
+#include "TestServer.h"
 
 //Provides a way to store end easily access client instances.
 #include "stormancer/IClientFactory.h"
@@ -7,7 +8,6 @@
 //Declares MainThreadActionDispatcher, a class that enables the dev to run stormancer callbacks & continuations on the thread of their choice.
 #include "stormancer/IActionDispatcher.h"
 
-constexpr const char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
 constexpr const char* Account = "tests";
 constexpr const char* Application = "test";
 
@@ -21,7 +21,7 @@ TEST(GameFlow, RejectConnection) {
 	Stormancer::IClientFactory::SetConfig(0, [dispatcher](size_t) {
 
 		//Create a configuration that connects to the test application.
-		auto config = Stormancer::Configuration::create(std::string(ServerEndpoint), std::string(Account), std::string(Application));
+		auto config = Stormancer::Configuration::create(testServerEndpoint(), std::string(Account), std::string(Application));
 
 		//Add plugins required by the test.
 		//config->addPlugin(new Stormancer::Users::UsersPlugin());
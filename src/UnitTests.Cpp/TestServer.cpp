@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "TestServer.h"
+#include "../StressTool/MetadataCache.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+	constexpr const char* ServerEndpoint = "http://localhost";//"http://gc3.stormancer.com";
+
+	std::string metadataCacheEndpoint()
+	{
+		auto ttl = std::getenv("TESTS_METADATA_CACHE_TTL");
+		if (ttl == nullptr || std::atof(ttl) <= 0)
+		{
+			return ServerEndpoint;
+		}
+		static std::unique_ptr<StressTool::MetadataCache> cache;
+		cache.reset(new StressTool::MetadataCache(ServerEndpoint, std::atof(ttl)));
+		if (!cache->start())
+		{
+			//The tests still run, against the server itself.
+			std::cout << "metadata cache: " << cache->error() << "\n";
+			return ServerEndpoint;
+		}
+		return cache->endpoint();
+	}
+}
+
+std::string testServerEndpoint()
+{
+	static const std::string endpoint = metadataCacheEndpoint();
+	return endpoint;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+/// <summary>
+/// API endpoint of the test server, given to the configurations of the tests.
+/// </summary>
+/// <remarks>
+/// If the TESTS_METADATA_CACHE_TTL environment variable is set to a TTL in seconds, the clients of the tests connect through a StressTool MetadataCache
+/// started on the first call, shared by all the tests of the process. The cache stays up until the process exits.
+/// </remarks>
+std::string testServerEndpoint();
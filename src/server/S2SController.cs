@@ -27,6 +27,21 @@ namespace Stormancer.Server.TestApp
                 await Task.Delay(100);
             }
         }
+
+        /// <summary>
+        /// Produces <paramref name="count"/> items as fast as the caller reads them.
+        /// </summary>
+        [S2SApi]
+        public async IAsyncEnumerable<TestDto> Stream(int count, int size)
+        {
+            var value = new string('x', size);
+            for (var i = 0; i < count; i++)
+            {
+                yield return new TestDto { Number = i, Value = value };
+                //Lets other producers of the host run between items.
+                await Task.Yield();
+            }
+        }
     }
 
 
@@ -0,0 +1,44 @@
+﻿using Stormancer.Core;
+using Stormancer.Plugins;
+using Stormancer.Server.Plugins.API;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Threading.Tasks;
+
+namespace Stormancer.Server.TestApp
+{
+    /// <summary>
+    /// Relays entity updates between the peers of the scene relay benchmark scene.
+    /// </summary>
+    /// <remarks>
+    /// This is a plain scene relay used by the C++ relay benchmark, not the replication plugin: its numbers don't describe replication plugin bandwidth.
+    /// </remarks>
+    internal class SceneRelayController : ControllerBase
+    {
+        private readonly ISceneHost scene;
+
+        public SceneRelayController(ISceneHost scene)
+        {
+            this.scene = scene;
+        }
+
+        /// <summary>
+        /// Broadcasts an entity update to all the peers connected to the scene, including its owner.
+        /// </summary>
+        /// <param name="packet"></param>
+        /// <returns></returns>
+        [Api(ApiAccess.Public, ApiType.FireForget)]
+        public Task Update(Packet<IScenePeerClient> packet)
+        {
+            using var buffer = new MemoryStream();
+            packet.Stream.CopyTo(buffer);
+            var data = buffer.ToArray();
+
+            scene.Send(new MatchAllFilter(), "relay.update", s => s.Write(data, 0, data.Length), PacketPriority.MEDIUM_PRIORITY, PacketReliability.UNRELIABLE);
+            return Task.CompletedTask;
+        }
+    }
+}
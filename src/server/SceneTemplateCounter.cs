@@ -0,0 +1,36 @@
+﻿using System.Collections.Concurrent;
+using System.Threading;
+
+namespace Stormancer.Server.TestApp
+{
+    /// <summary>
+    /// Number of scenes of each template running on the host, updated when scenes are created and shut down.
+    /// </summary>
+    /// <remarks>
+    /// Replaces enumerating all the scenes of the host to count those of a template, whose cost grows with the number of scenes.
+    /// </remarks>
+    public class SceneTemplateCounter
+    {
+        private class Counter
+        {
+            public int Value;
+        }
+
+        private readonly ConcurrentDictionary<string, Counter> counters = new ConcurrentDictionary<string, Counter>();
+
+        public void SceneCreated(string template)
+        {
+            Interlocked.Increment(ref counters.GetOrAdd(template, _ => new Counter()).Value);
+        }
+
+        public void SceneShutdown(string template)
+        {
+            Interlocked.Decrement(ref counters.GetOrAdd(template, _ => new Counter()).Value);
+        }
+
+        public int Count(string template)
+        {
+            return counters.TryGetValue(template, out var counter) ? Volatile.Read(ref counter.Value) : 0;
+        }
+    }
+}
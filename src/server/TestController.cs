@@ -1,9 +1,13 @@
-﻿using Stormancer.Core;
+﻿using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using Stormancer.Core;
 using Stormancer.Server.Components;
 using Stormancer.Server.Plugins.API;
 using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Runtime.CompilerServices;
+using System.Security.Cryptography;
 using System.Text;
 using System.Threading;
 using System.Threading.Channels;
@@ -19,14 +23,18 @@ namespace Stormancer.Server.TestApp
         private readonly IHost host;
         private readonly ISerializer serializer;
         private readonly IEnvironment environment;
+        private readonly SceneTemplateCounter sceneCounts;
+        private readonly IConfiguration configuration;
 
-        public TestController(S2SProxy proxy, TestProxy selfProxy, IHost host, ISerializer serializer, IEnvironment environment)
+        public TestController(S2SProxy proxy, TestProxy selfProxy, IHost host, ISerializer serializer, IEnvironment environment, SceneTemplateCounter sceneCounts, IConfiguration configuration)
         {
             this.proxy = proxy;
             this.selfProxy = selfProxy;
             this.host = host;
             this.serializer = serializer;
             this.environment = environment;
+            this.sceneCounts = sceneCounts;
+            this.configuration = configuration;
         }
 
 
@@ -50,6 +58,97 @@ namespace Stormancer.Server.TestApp
             return AsyncEnumerable.Range(0, TestPlugin.S2S_SCENE_COUNT).Merge(i => proxy.AsyncEnumerable(i.ToString(), cancellationToken), cancellationToken);
         }
 
+        /// <summary>
+        /// Streams <paramref name="count"/> items of <paramref name="size"/> characters from each S2S scene, merged through a buffer of <paramref name="capacity"/> items.
+        /// </summary>
+        /// <remarks>
+        /// Used by the StressTool slowconsumer benchmark. A capacity of 0 uses an unbounded buffer, to compare with the previous behavior of Merge:
+        /// as it lets the stream grow the memory of the server, it requires the admin key of the application configuration (see UpdatePeerConfiguration).
+        /// The stream is limited to <see cref="TestPlugin.MAX_STREAM_BYTES"/> over all the S2S scenes.
+        /// </remarks>
+        [Api(ApiAccess.Public, ApiType.Rpc)]
+        public IAsyncEnumerable<TestDto> TestS2SStream(int count, int size, int capacity, string adminKey, CancellationToken cancellationToken)
+        {
+            if (count < 0 || size < 0 || (long)count * size * TestPlugin.S2S_SCENE_COUNT > TestPlugin.MAX_STREAM_BYTES)
+            {
+                throw new ClientException($"count * size must be under {TestPlugin.MAX_STREAM_BYTES / TestPlugin.S2S_SCENE_COUNT} bytes per S2S scene");
+            }
+            if (capacity <= 0)
+            {
+                CheckAdminKey(adminKey);
+            }
+            return AsyncEnumerable.Range(0, TestPlugin.S2S_SCENE_COUNT).Merge(i => proxy.Stream(i.ToString(), count, size, cancellationToken), capacity, cancellationToken);
+        }
+
+        /// <summary>
+        /// Creates the load scenes 0 to <paramref name="count"/> - 1 that don't exist yet on the host, and returns the number of load scenes already running.
+        /// </summary>
+        /// <remarks>
+        /// Used by the StressTool appfunction benchmark to measure scenes.count with many scenes on the host.
+        /// <paramref name="count"/> can't exceed <see cref="TestPlugin.MAX_LOAD_SCENES"/>.
+        /// </remarks>
+        [Api(ApiAccess.Public, ApiType.Rpc)]
+        public int CreateLoadScenes(int count)
+        {
+            if (count < 0 || count > TestPlugin.MAX_LOAD_SCENES)
+            {
+                throw new ClientException($"count must be between 0 and {TestPlugin.MAX_LOAD_SCENES}");
+            }
+            for (int i = 0; i < count; i++)
+            {
+                host.EnsureSceneExists(TestPlugin.GetLoadSceneId(i), TestPlugin.LOAD_SCENE_TEMPLATE, isPublic: false, isPersistent: true);
+            }
+            return sceneCounts.Count(TestPlugin.LOAD_SCENE_TEMPLATE);
+        }
+
+        /// <summary>
+        /// Replaces the section of the application configuration read by the PeerConfiguration plugin with <paramref name="peerConfiguration"/>, a JSON object.
+        /// The plugin then pushes it to every connected client.
+        /// </summary>
+        /// <remarks>
+        /// Used by the StressTool peerconfig benchmark, which measures the push latency from this call.
+        /// Disabled unless the application configuration sets stressTool.adminKey, which callers must give, and stressTool.peerConfigurationSection,
+        /// the section the PeerConfiguration plugin pushes (see configs/test-peerconfig.json).
+        /// </remarks>
+        [Api(ApiAccess.Public, ApiType.Rpc)]
+        public void UpdatePeerConfiguration(string adminKey, string peerConfiguration)
+        {
+            var settings = CheckAdminKey(adminKey);
+            var sectionName = (string)settings.SelectToken(TestPlugin.PEER_CONFIGURATION_SECTION_SETTING);
+            if (string.IsNullOrEmpty(sectionName))
+            {
+                throw new ClientException($"peer configuration updates are disabled: set {TestPlugin.PEER_CONFIGURATION_SECTION_SETTING} in the application configuration");
+            }
+
+            JObject section;
+            try
+            {
+                section = JObject.Parse(peerConfiguration);
+            }
+            catch (JsonReaderException ex)
+            {
+                throw new ClientException("peerConfiguration must be a JSON object: " + ex.Message);
+            }
+            settings[sectionName] = section;
+            configuration.SetSettings(settings);
+        }
+
+        //Routes that can change the configuration or the memory use of the server require stressTool.adminKey, and are disabled if it isn't set.
+        private JObject CheckAdminKey(string adminKey)
+        {
+            var settings = JObject.FromObject(configuration.Settings);
+            var expectedKey = (string)settings.SelectToken(TestPlugin.ADMIN_KEY_SETTING);
+            if (string.IsNullOrEmpty(expectedKey))
+            {
+                throw new ClientException($"disabled: set {TestPlugin.ADMIN_KEY_SETTING} in the application configuration");
+            }
+            if (!CryptographicOperations.FixedTimeEquals(Encoding.UTF8.GetBytes(adminKey ?? ""), Encoding.UTF8.GetBytes(expectedKey)))
+            {
+                throw new ClientException("invalid admin key");
+            }
+            return settings;
+        }
+
         /// <summary>
         /// Demonstrates disconnecting a player from the server.
         /// </summary>
@@ -95,26 +194,88 @@ namespace Stormancer.Server.TestApp
 
     public static class AsyncEnumerableExtensions
     {
+        /// <summary>
+        /// Default number of items buffered by Merge between the producers and the consumer.
+        /// </summary>
+        public const int DefaultMergeCapacity = 64;
+
         public static IAsyncEnumerable<TResult> Merge<T, TResult>(this IAsyncEnumerable<T> source, Func<T, IAsyncEnumerable<TResult>> selector, CancellationToken cancellationToken)
         {
-            var channel = Channel.CreateUnbounded<TResult>();
+            return source.Merge(selector, DefaultMergeCapacity, cancellationToken);
+        }
+
+        /// <summary>
+        /// Enumerates the sequences produced by <paramref name="selector"/> for each item of <paramref name="source"/> concurrently, and yields their items as they arrive.
+        /// </summary>
+        /// <remarks>
+        /// At most <paramref name="capacity"/> items are buffered: when the consumer is slower than the producers, producers wait for it instead of growing the buffer.
+        /// Each producer waits with at most one item and waiting writers are served in order, so a fast producer can't starve the others.
+        /// Producers are cancelled when <paramref name="cancellationToken"/> is cancelled, when the consumer stops enumerating or when one of them fails, and the first error is rethrown to the consumer.
+        /// A capacity of 0 or less uses an unbounded buffer.
+        /// </remarks>
+        public static async IAsyncEnumerable<TResult> Merge<T, TResult>(this IAsyncEnumerable<T> source, Func<T, IAsyncEnumerable<TResult>> selector, int capacity, [EnumeratorCancellation] CancellationToken cancellationToken = default)
+        {
+            var channel = capacity > 0
+                ? Channel.CreateBounded<TResult>(new BoundedChannelOptions(capacity) { FullMode = BoundedChannelFullMode.Wait, SingleReader = true })
+                : Channel.CreateUnbounded<TResult>(new UnboundedChannelOptions { SingleReader = true });
+
+            //The first fault is the one the consumer sees. Cancelling stops the other producers, instead of letting them run until the consumer reads the error.
+            static void Fail(ChannelWriter<TResult> writer, Exception error, CancellationTokenSource cts)
+            {
+                if (writer.TryComplete(error))
+                {
+                    cts.Cancel();
+                }
+            }
 
-            static async Task ReadAllAsync(ChannelWriter<TResult> writer, IAsyncEnumerable<T> sequence, Func<T, IAsyncEnumerable<TResult>> selector)
+            static async Task ReadAllAsync(ChannelWriter<TResult> writer, IAsyncEnumerable<T> sequence, Func<T, IAsyncEnumerable<TResult>> selector, CancellationTokenSource cts)
             {
-                static async Task ReadImpl(IAsyncEnumerable<TResult> producer, ChannelWriter<TResult> writer)
+                static async Task ReadImpl(IAsyncEnumerable<TResult> producer, ChannelWriter<TResult> writer, CancellationTokenSource cts)
+                {
+                    try
+                    {
+                        await foreach (var item in producer.WithCancellation(cts.Token))
+                        {
+                            await writer.WriteAsync(item, cts.Token);
+                        }
+                    }
+                    catch (Exception ex)
+                    {
+                        Fail(writer, ex, cts);
+                    }
+                }
+
+                var producers = new List<Task>();
+                try
                 {
-                    await foreach (var item in producer)
+                    await foreach (var value in sequence.WithCancellation(cts.Token))
                     {
-                        await writer.WriteAsync(item);
+                        producers.Add(ReadImpl(selector(value), writer, cts));
                     }
                 }
-                var list = await sequence.Select(selector).Select(producer => ReadImpl(producer, writer)).ToListAsync();
-                await Task.WhenAll(list);
-                writer.Complete();
+                catch (Exception ex)
+                {
+                    Fail(writer, ex, cts);
+                }
+                await Task.WhenAll(producers);
+                writer.TryComplete();
             }
-            _ = ReadAllAsync(channel.Writer, source, selector); //Don't wait for completion.
 
-            return channel.Reader.ReadAllAsync(cancellationToken);
+            using var cts = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            var readAll = ReadAllAsync(channel.Writer, source, selector, cts);
+            try
+            {
+                await foreach (var item in channel.Reader.ReadAllAsync(cancellationToken))
+                {
+                    yield return item;
+                }
+            }
+            finally
+            {
+                //Stops the producers if the consumer stopped before the end, and waits for them so that none outlives the enumeration.
+                cts.Cancel();
+                await readAll;
+            }
         }
     }
 }
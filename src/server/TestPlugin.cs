@@ -15,6 +15,17 @@ namespace Stormancer.Server.TestApp
         public const int S2S_SCENE_COUNT = 10;
         public const string S2S_SCENE_TEMPLATE = "template-s2s";
         public static string GetS2SSceneId(string n) => "test-s2s-" + n;
+        public const string RELAY_BENCH_SCENE = "relay-bench";
+        //Template of the empty scenes created by TestController.CreateLoadScenes.
+        public const string LOAD_SCENE_TEMPLATE = "load-scene";
+        public static string GetLoadSceneId(int n) => "load-" + n;
+        //Upper bound of the count accepted by TestController.CreateLoadScenes, so that a client can't exhaust the host.
+        public const int MAX_LOAD_SCENES = 10000;
+        //Bytes of items streamed by TestController.TestS2SStream, over all the S2S scenes.
+        public const long MAX_STREAM_BYTES = 64L * 1024 * 1024;
+        //Settings enabling TestController.UpdatePeerConfiguration and unbounded TestS2SStream calls: the key callers must give, and the configuration section pushed by the PeerConfiguration plugin.
+        public const string ADMIN_KEY_SETTING = "stressTool.adminKey";
+        public const string PEER_CONFIGURATION_SECTION_SETTING = "stressTool.peerConfigurationSection";
 
         public void Build(HostPluginBuildContext ctx)
         {
@@ -25,8 +36,19 @@ namespace Stormancer.Server.TestApp
                 builder.Register<UsersTestController>();
                 builder.Register<TestServiceLocator>().As<IServiceLocatorProvider>();
                 builder.Register<RejectConnectionController>();
+                builder.Register<SceneRelayController>();
+                builder.Register<SceneTemplateCounter>().SingleInstance();
 
             };
+            ctx.SceneCreated += (ISceneHost scene) =>
+            {
+                scene.DependencyResolver.Resolve<SceneTemplateCounter>().SceneCreated(scene.Template);
+            };
+            ctx.SceneShutdown += (ISceneHost scene) =>
+            {
+                scene.DependencyResolver.Resolve<SceneTemplateCounter>().SceneShutdown(scene.Template);
+            };
+
             ctx.HostStarting += (IHost host) =>
             {
 
@@ -57,6 +79,15 @@ namespace Stormancer.Server.TestApp
                     scene.AddReplication();
                 });
 
+                host.AddSceneTemplate(RELAY_BENCH_SCENE, scene =>
+                {
+                    scene.AddController<SceneRelayController>();
+                });
+
+                host.AddSceneTemplate(LOAD_SCENE_TEMPLATE, scene =>
+                {
+                });
+
                 host.AddSceneTemplate("rejection-test-scene", scene => 
                 {
                     scene.AddController<RejectConnectionController>();
@@ -101,7 +132,7 @@ namespace Stormancer.Server.TestApp
                     var serializer = ctx.Resolver.Resolve<ISerializer>();
                     var template = await serializer.DeserializeAsync<string>(ctx.Input, CancellationToken.None);
 
-                    await serializer.SerializeAsync(host.EnumerateScenes().Count(s => s.Template == template), ctx.Output, CancellationToken.None);
+                    await serializer.SerializeAsync(ctx.Resolver.Resolve<SceneTemplateCounter>().Count(template), ctx.Output, CancellationToken.None);
                 });
             };
 
@@ -120,6 +151,9 @@ namespace Stormancer.Server.TestApp
                 }
 
                 host.EnsureSceneExists("rejection-test-scene", "rejection-test-scene", true, true);
+                host.EnsureSceneExists("test-connection-rejected", "test-connection-rejected", true, true);
+
+                host.EnsureSceneExists(RELAY_BENCH_SCENE, RELAY_BENCH_SCENE, isPublic: true, isPersistent: true);
 
             };
 